@@ -0,0 +1,323 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Batch mode: replays many independent trace files at once on a pool of worker threads
+ * --> The files are either listed in a file (one path per line, blank lines and lines
+ *     starting with '#' are skipped) or are every visible regular file in a directory
+ * --> Each worker takes the next file, replays it with its own dispatcher, and frees it
+ *     before taking another, so the replays' memory depends on the number of workers, not
+ *     of files (with an output directory, each listed file's name is also kept until the
+ *     batch ends, to catch collisions, so that part grows by one name per file)
+ * --> Each file's output goes either to <out dir>/<file name>.out (and anything it would
+ *     have printed to stderr to <file name>.err), or to one merged report on stdout where
+ *     each file's output follows a "# <path>" line (files appear in the order they finish)
+ * --> With an output directory, a listed file with the same name as one listed before it
+ *     (eg. a/x.in and b/x.in) isn't replayed, since its output would replace the other's
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#include "batch.h"
+
+// =================================== STRUCTS ====================================
+
+/**
+ * What every worker shares
+ * --> lock guards taking the next file, and report guards writing to stdout/stderr
+ */
+typedef struct batch_struct {
+    pthread_mutex_t lock;
+    pthread_mutex_t report;
+    const char *source;         // the list file or directory
+    DIR *dir;                   // the directory being listed (NULL for a list file)
+    FILE *list;                 // the list file being read (NULL for a directory)
+    char *line;                 // the list file's current line
+    size_t lineCapacity;
+    char **names;               // file names given out so far (open addressing, NULL if empty)
+    size_t nameCapacity, numNames;
+    const char *outDir;         // where each file's output goes (NULL for a merged report)
+    InputFormat format;
+    const DispatcherConfig *config;
+    int failures;               // how many files couldn't be replayed
+} Batch;
+
+// ================================== MY HELPERS ==================================
+
+/**
+ * Helper that gets the file name part of a path
+ * @param const char *path -the path
+ * @return what's after its last '/' (the whole path if it has none)
+ */
+static const char* fileName(const char *path) {
+    const char *name = strrchr(path, '/');
+    return (name == NULL) ? path : name + 1;
+}
+
+/**
+ * Helper that claims a file name for one file's output, unless another file has it
+ * @param Batch *batch -the batch (its lock held)
+ * @param const char *name -the file name
+ * @return 1 if it's claimed, 0 if a file before had the same name
+ */
+static int claimName(Batch *batch, const char *name) {
+    // grow first, re-inserting everything into the bigger table
+    if((batch->numNames + 1) * 2 > batch->nameCapacity) {
+        char **old = batch->names;
+        size_t oldCapacity = batch->nameCapacity;
+        batch->nameCapacity = oldCapacity == 0 ? 64 : oldCapacity * 2;
+        batch->names = calloc(batch->nameCapacity, sizeof(char*));
+        batch->numNames = 0;
+        for(size_t i = 0; i < oldCapacity; i++) {
+            if(old[i] != NULL) {
+                claimName(batch, old[i]);
+                free(old[i]);
+            }
+        }
+        free(old);
+    }
+
+    // FNV-1a, then probe for an empty entry, making sure the name isn't already there
+    unsigned int hash = 2166136261u;
+    for(const char *c = name; *c != '\0'; c++) {
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    }
+    size_t i = hash & (batch->nameCapacity - 1);
+    while(batch->names[i] != NULL) {
+        if(strcmp(batch->names[i], name) == 0) {
+            return 0;
+        }
+        i = (i + 1) & (batch->nameCapacity - 1);
+    }
+    batch->names[i] = strdup(name);
+    batch->numNames++;
+    return 1;
+}
+
+/**
+ * Helper that gets the path of the next file to replay
+ * --> a listed file whose output would replace another's is reported and skipped
+ * @param Batch *batch -the batch
+ * @return the path (to be freed), or NULL if there are no more files
+ */
+static char* nextPath(Batch *batch) {
+    char *path = NULL;
+    pthread_mutex_lock(&batch->lock);
+    if(batch->dir != NULL) {
+        struct dirent *entry;
+        struct stat info;
+        while(path == NULL && (entry = readdir(batch->dir)) != NULL) {
+            if(entry->d_name[0] == '.') {
+                continue;
+            }
+            path = malloc(strlen(batch->source) + strlen(entry->d_name) + 2);
+            sprintf(path, "%s/%s", batch->source, entry->d_name);
+            if(stat(path, &info) != 0 || !S_ISREG(info.st_mode)) {
+                free(path);
+                path = NULL;
+            }
+        }
+    } else {
+        ssize_t length;
+        while(path == NULL && (length = getline(&batch->line, &batch->lineCapacity, batch->list)) != -1) {
+            while(length > 0 && (batch->line[length-1] == '\n' || batch->line[length-1] == '\r')) {
+                batch->line[--length] = '\0';
+            }
+            if(length > 0 && batch->line[0] != '#') {
+                path = strdup(batch->line);
+            }
+            if(path != NULL && batch->outDir != NULL && !claimName(batch, fileName(path))) {
+                pthread_mutex_lock(&batch->report);
+                fprintf(stderr, "Error: %s has the same file name as a file before it (its output would replace that one's) --skipping it\n", path);
+                pthread_mutex_unlock(&batch->report);
+                batch->failures++;
+                free(path);
+                path = NULL;
+            }
+        }
+    }
+    pthread_mutex_unlock(&batch->lock);
+    return path;
+}
+
+/**
+ * Helper that opens a file in the output directory for one trace file's output
+ * @param Batch *batch -the batch
+ * @param const char *path -the trace file
+ * @param const char *suffix -added to the trace file's name (eg. ".out")
+ * @return the opened file, or NULL if it can't be
+ */
+static FILE* openOutput(Batch *batch, const char *path, const char *suffix) {
+    const char *name = fileName(path);
+    char *outPath = malloc(strlen(batch->outDir) + strlen(name) + strlen(suffix) + 2);
+    sprintf(outPath, "%s/%s%s", batch->outDir, name, suffix);
+    FILE *out = fopen(outPath, "w");
+    if(out == NULL) {
+        fprintf(stderr, "Error: could not create output file %s\n", outPath);
+    }
+    free(outPath);
+    return out;
+}
+
+/**
+ * Helper that replays one trace file with its own dispatcher and writes its output
+ * @param Batch *batch -the batch
+ * @param const char *path -the trace file
+ * @return 1 if it was replayed, otherwise 0
+ */
+static int replayFile(Batch *batch, const char *path) {
+    EventReader reader;
+    if(!openReader(&reader, path, batch->format)) {
+        pthread_mutex_lock(&batch->report);
+        fprintf(stderr, "Error: could not open input file %s\n", path);
+        pthread_mutex_unlock(&batch->report);
+        return 0;
+    }
+
+    // the output goes straight to its file, or is kept until it can be added to the report
+    char *outText = NULL, *logText = NULL;
+    size_t outSize = 0, logSize = 0;
+    FILE *out = (batch->outDir != NULL) ? openOutput(batch, path, ".out") : open_memstream(&outText, &outSize);
+    FILE *log = open_memstream(&logText, &logSize);
+    if(out == NULL || log == NULL) {
+        closeReader(&reader);
+        if(out != NULL) fclose(out);
+        if(log != NULL) fclose(log);
+        free(outText);
+        free(logText);
+        return 0;
+    }
+
+    Dispatcher d;
+    Event *events = malloc(EVENT_BATCH * sizeof(Event));
+    int count;
+    initDispatcher(&d, batch->config);
+    d.out = out;
+    d.log = reader.log = log;
+    do {
+        count = nextEvents(&reader, events, EVENT_BATCH);
+        processEvents(&d, events, count);
+    } while(count == EVENT_BATCH);
+    free(events);
+    closeReader(&reader);
+    printResults(&d, out);
+    deleteDispatcher(&d);
+    fclose(out);
+    fclose(log);
+
+    // errors/notices go next to the output file, or after the file's output in the report
+    int ok = 1;
+    if(batch->outDir != NULL) {
+        if(logSize > 0) {
+            FILE *errOut = openOutput(batch, path, ".err");
+            if(errOut != NULL) {
+                fwrite(logText, 1, logSize, errOut);
+                fclose(errOut);
+            } else {
+                ok = 0;
+            }
+        }
+    } else {
+        pthread_mutex_lock(&batch->report);
+        printf("# %s\n", path);
+        fwrite(outText, 1, outSize, stdout);
+        if(logSize > 0) {
+            fprintf(stderr, "# %s\n", path);
+            fwrite(logText, 1, logSize, stderr);
+        }
+        pthread_mutex_unlock(&batch->report);
+    }
+    free(outText);
+    free(logText);
+    return ok;
+}
+
+/**
+ * Helper that one worker thread runs: replays files until there are none left
+ * @param void *arg -the batch
+ * @return NULL
+ */
+static void* worker(void *arg) {
+    Batch *batch = arg;
+    char *path;
+    while((path = nextPath(batch)) != NULL) {
+        if(!replayFile(batch, path)) {
+            pthread_mutex_lock(&batch->lock);
+            batch->failures++;
+            pthread_mutex_unlock(&batch->lock);
+        }
+        free(path);
+    }
+    return NULL;
+}
+
+// ================================ BATCH FUNCTIONS ===============================
+
+/**
+ * Replays every trace file in a list file or directory, several at a time
+ * @param const char *source -the list file or directory
+ * @param int jobs -how many files are replayed at once (at least 1)
+ * @param const char *outDir -the directory each file's output goes in (NULL for a merged report on stdout)
+ * @param InputFormat format -the format of every trace file
+ * @param const DispatcherConfig *config -how each file's dispatcher is set up
+ * @return 0 if every file was replayed, otherwise 1
+ */
+int runBatch(const char *source, int jobs, const char *outDir, InputFormat format,
+             const DispatcherConfig *config) {
+    Batch batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.source = source;
+    batch.outDir = outDir;
+    batch.format = format;
+    batch.config = config;
+
+    struct stat info;
+    if(stat(source, &info) == 0 && S_ISDIR(info.st_mode)) {
+        batch.dir = opendir(source);
+    } else {
+        batch.list = fopen(source, "r");
+    }
+    if(batch.dir == NULL && batch.list == NULL) {
+        fprintf(stderr, "Error: could not open batch %s\n", source);
+        return 1;
+    }
+    if(outDir != NULL && (stat(outDir, &info) != 0 || !S_ISDIR(info.st_mode))) {
+        fprintf(stderr, "Error: output directory %s does not exist\n", outDir);
+        if(batch.dir != NULL) closedir(batch.dir);
+        if(batch.list != NULL) fclose(batch.list);
+        return 1;
+    }
+    pthread_mutex_init(&batch.lock, NULL);
+    pthread_mutex_init(&batch.report, NULL);
+
+    // start the workers (this thread is one of them) and wait for them to run out of files
+    pthread_t *threads = malloc(sizeof(pthread_t) * jobs);
+    int started = 0;
+    while(started < jobs - 1 && pthread_create(&threads[started], NULL, worker, &batch) == 0) {
+        started++;
+    }
+    worker(&batch);
+    for(int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+
+    pthread_mutex_destroy(&batch.lock);
+    pthread_mutex_destroy(&batch.report);
+    if(batch.dir != NULL) closedir(batch.dir);
+    if(batch.list != NULL) fclose(batch.list);
+    free(batch.line);
+    for(size_t i = 0; i < batch.nameCapacity; i++) {
+        free(batch.names[i]);
+    }
+    free(batch.names);
+    return batch.failures > 0;
+}
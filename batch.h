@@ -0,0 +1,19 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Batch mode: replays many independent trace files at once on a pool of worker threads
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "events.h"
+#include "dispatcher.h"
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+int runBatch(const char *source, int jobs, const char *outDir, InputFormat format,
+             const DispatcherConfig *config);
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Micro-benchmark for the PCB layout: the PCB table (structure of arrays, queues linked
+ *     by 32-bit slots, see pcb.h) against the layout it replaced, one struct per process
+ *     with every field in it and queues linked by pointers
+ * --> both layouts are given the same processes in the same (shuffled) queue order, so
+ *     only the layout differs:
+ *      - rotate: pop the front of the ready queue, charge it for running, push it back (T)
+ *      - remove: unlink a random process from the middle of the queue, push it back (R/I)
+ *      - scan: add up every process's times, as the final report does
+ *
+ * Usage: ./layout_bench [max processes] [operations per size]
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../pcb.h"
+
+// =================================== STRUCTS ====================================
+
+/**
+ * The old layout: every field of a process in one struct, queues linked by pointers
+ */
+typedef struct old_pcb_struct {
+    int pid;
+    ProcessState status;
+    int prevTime, runTime, readyTime, blockTime;
+    int cpu, resource, runStart;
+    struct old_pcb_struct *next, *prev;
+    void *owner;
+    int priority, heapIndex, level, quantumUsed, burstEstimate, burstBase;
+    long long sortKey, seq, pass;
+} OldPCB;
+
+typedef struct old_queue_struct {
+    OldPCB *head, *tail;
+    int length;
+} OldQueue;
+
+// ================================================================================
+
+/**
+ * Helper that gets the current time in nanoseconds
+ * @return the monotonic clock's current time, in ns
+ */
+static double nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * Helper that adds a process to the back of an old layout queue
+ * @param OldQueue *queue -the queue
+ * @param OldPCB *p -the process
+ */
+static void oldPushBack(OldQueue *queue, OldPCB *p) {
+    p->next = NULL;
+    p->prev = queue->tail;
+    p->owner = queue;
+    if(queue->tail == NULL) {
+        queue->head = p;
+    } else {
+        queue->tail->next = p;
+    }
+    queue->tail = p;
+    queue->length++;
+}
+
+/**
+ * Helper that unlinks a process from an old layout queue
+ * @param OldQueue *queue -the queue
+ * @param OldPCB *p -the process (must be in the queue)
+ */
+static void oldRemove(OldQueue *queue, OldPCB *p) {
+    if(p->prev != NULL) {
+        p->prev->next = p->next;
+    } else {
+        queue->head = p->next;
+    }
+    if(p->next != NULL) {
+        p->next->prev = p->prev;
+    } else {
+        queue->tail = p->prev;
+    }
+    p->next = p->prev = NULL;
+    p->owner = NULL;
+    queue->length--;
+}
+
+// ================================================================================
+
+int main( int argc, char *argv[] ) {
+    int maxCount = argc > 1 ? atoi(argv[1]) : 1000000;
+    int ops = argc > 2 ? atoi(argv[2]) : 2000000;
+    if(maxCount < 1000 || ops < 1) {
+        fprintf(stderr, "Usage: %s [max processes >= 1000] [operations per size]\n", argv[0]);
+        return 1;
+    }
+
+    printf("old PCB: %zu bytes per process\n", sizeof(OldPCB));
+    size_t dense = sizeof(int) + sizeof(uint8_t) + 4 * sizeof(long long) + 2 * sizeof(Slot);
+    printf("table:   %zu bytes per process (%zu in the dense arrays, %zu in PCBInfo)\n",
+           dense + sizeof(PCBInfo), dense, sizeof(PCBInfo));
+    printf("%10s %8s %14s %14s %14s\n", "processes", "layout", "rotate ns/op", "remove ns/op", "scan ns/pcb");
+    for(int count = 1000; count <= maxCount; count *= 10) {
+        // the same shuffled order for both layouts
+        unsigned int seed = 12345;
+        int *order = malloc(count * sizeof(int));
+        for(int i = 0; i < count; i++) {
+            order[i] = i;
+        }
+        for(int i = count - 1; i > 0; i--) {
+            seed = seed * 1103515245u + 12345u;
+            int j = (int)((seed >> 8) % (unsigned int)(i + 1));
+            int temp = order[i];
+            order[i] = order[j];
+            order[j] = temp;
+        }
+        int *picks = malloc(ops * sizeof(int));
+        for(int i = 0; i < ops; i++) {
+            seed = seed * 1103515245u + 12345u;
+            picks[i] = (int)((seed >> 8) % (unsigned int)count);
+        }
+
+        // ---------------------------- old layout ----------------------------
+        OldPCB *old = calloc(count, sizeof(OldPCB));
+        OldQueue oldReady = { NULL, NULL, 0 };
+        for(int i = 0; i < count; i++) {
+            old[order[i]].pid = order[i] + 1;
+            oldPushBack(&oldReady, &old[order[i]]);
+        }
+        double start = nowNs();
+        for(int i = 0; i < ops; i++) {
+            OldPCB *p = oldReady.head;
+            oldRemove(&oldReady, p);
+            p->runTime += 1;
+            p->prevTime = i;
+            oldPushBack(&oldReady, p);
+        }
+        double oldRotate = (nowNs() - start) / ops;
+        start = nowNs();
+        for(int i = 0; i < ops; i++) {
+            OldPCB *p = &old[picks[i]];
+            oldRemove(&oldReady, p);
+            oldPushBack(&oldReady, p);
+        }
+        double oldRemoveNs = (nowNs() - start) / ops;
+        long long oldSum = 0;
+        start = nowNs();
+        for(OldPCB *p = oldReady.head; p != NULL; p = p->next) {
+            oldSum += p->pid + p->runTime + p->readyTime + p->blockTime;
+        }
+        double oldScan = (nowNs() - start) / count;
+        printf("%10d %8s %14.1f %14.1f %14.2f\n", count, "old", oldRotate, oldRemoveNs, oldScan);
+        free(old);
+
+        // ----------------------------- PCB table ----------------------------
+        PCBTable table;
+        Queue ready;
+        initTable(&table);
+        initQueue(&ready);
+        for(int i = 0; i < count; i++) {
+            createPCB(&table, 0, i + 1);    // slot i is pid i + 1
+        }
+        for(int i = 0; i < count; i++) {
+            pushBack(&table, &ready, (Slot)order[i]);
+        }
+        start = nowNs();
+        for(int i = 0; i < ops; i++) {
+            Slot p = popFront(&table, &ready);
+            table.runTime[p] += 1;
+            table.prevTime[p] = i;
+            pushBack(&table, &ready, p);
+        }
+        double rotate = (nowNs() - start) / ops;
+        start = nowNs();
+        for(int i = 0; i < ops; i++) {
+            Slot p = (Slot)picks[i];
+            removePCB(&table, &ready, p);
+            pushBack(&table, &ready, p);
+        }
+        double removeNs = (nowNs() - start) / ops;
+        long long sum = 0;
+        start = nowNs();
+        for(Slot p = 0; p < table.used; p++) {
+            sum += table.pid[p] + table.runTime[p] + table.readyTime[p] + table.blockTime[p];
+        }
+        double scan = (nowNs() - start) / count;
+        printf("%10d %8s %14.1f %14.1f %14.2f\n", count, "table", rotate, removeNs, scan);
+        if(sum != oldSum) {
+            fprintf(stderr, "Error: the layouts disagree (%lld vs %lld)\n", sum, oldSum);
+        }
+        deleteTable(&table);
+        free(order);
+        free(picks);
+    }
+    return 0;
+}
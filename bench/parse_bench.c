@@ -0,0 +1,130 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Benchmark for the input path: parse throughput (MB/s and events/s) of the original
+ *     fgets/strtok/atoi path against the event reader, both mapped and buffered
+ *
+ * Usage: ./parse_bench [trace file]
+ * --> without a trace file, a synthetic one of 10M events is written to /tmp first
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "../events.h"
+
+#define SYNTHETIC_EVENTS 10000000
+
+// ================================================================================
+
+/**
+ * Helper that gets the current time in seconds
+ * @return the monotonic clock's current time, in s
+ */
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Helper that writes a synthetic trace (creates, timer ticks, requests, interrupts, exits)
+ * @param const char *path -the file to write
+ * @param int count -about how many events to write
+ */
+static void writeSynthetic(const char *path, int count) {
+    FILE *out = fopen(path, "w");
+    if(out == NULL) {
+        fprintf(stderr, "Error: could not write %s\n", path);
+        exit(1);
+    }
+    int time = 0;
+    for(int pid = 1; time < count; pid++) {
+        fprintf(out, "%d C %d\n", ++time, pid);
+        fprintf(out, "%d T\n", ++time);
+        fprintf(out, "%d R %d %d\n", ++time, 1 + pid % 5, pid);
+        fprintf(out, "%d I %d %d\n", ++time, 1 + pid % 5, pid);
+        fprintf(out, "%d E %d\n", ++time, pid);
+    }
+    fprintf(out, "\n");
+    fclose(out);
+}
+
+/**
+ * Helper that prints the throughput of one run
+ * @param const char *name -which input path was run
+ * @param double bytes -size of the input
+ * @param long events -how many events were parsed
+ * @param double seconds -how long it took
+ * @param long checksum -sum of the parsed fields (so none of the parsing is optimized out)
+ */
+static void report(const char *name, double bytes, long events, double seconds, long checksum) {
+    printf("%-18s %10.1f MB/s %14.0f events/s  (%ld events, %.3f s, checksum %ld)\n",
+        name, bytes / seconds / 1e6, events / seconds, events, seconds, checksum);
+}
+
+int main( int argc, char *argv[] ) {
+    const char *path = argc > 1 ? argv[1] : "/tmp/idispatcher_parse_bench.txt";
+    if(argc <= 1) {
+        writeSynthetic(path, SYNTHETIC_EVENTS);
+    }
+    struct stat st;
+    if(stat(path, &st) != 0) {
+        fprintf(stderr, "Error: could not open input file %s\n", path);
+        return 1;
+    }
+    double bytes = st.st_size;
+
+    // original path: fgets, flushInput, then parseInputLine (strtok/atoi)
+    if(freopen(path, "r", stdin) == NULL) {
+        fprintf(stderr, "Error: could not open input file %s\n", path);
+        return 1;
+    }
+    char line[102];
+    char event = '\0';
+    int currTime = 0, prevTime = 0, resourceNum = -1, pid = 0;
+    long events = 0, checksum = 0;
+    double start = nowSec();
+    while(fgets(line, 102, stdin) != NULL) {
+        flushInput(line);
+        if(line[0] == '\0') break;
+        parseInputLine(line, &prevTime, &currTime, &event, &resourceNum, &pid);
+        checksum += currTime + event + resourceNum + pid;
+        events++;
+    }
+    report("fgets/strtok/atoi", bytes, events, nowSec() - start, checksum);
+
+    // event reader, memory-mapped
+    EventReader reader;
+    Event next;
+    events = checksum = 0;
+    start = nowSec();
+    openReader(&reader, path, TEXT_FORMAT);
+    while(nextEvent(&reader, &next)) {
+        checksum += next.time + next.type + next.resourceNum + next.pid;
+        events++;
+    }
+    closeReader(&reader);
+    report("reader (mmap)", bytes, events, nowSec() - start, checksum);
+
+    // event reader, buffered reads (the way stdin is read)
+    int fd = open(path, O_RDONLY);
+    events = checksum = 0;
+    start = nowSec();
+    openReaderFd(&reader, fd, TEXT_FORMAT);
+    while(nextEvent(&reader, &next)) {
+        checksum += next.time + next.type + next.resourceNum + next.pid;
+        events++;
+    }
+    closeReader(&reader);
+    close(fd);
+    report("reader (buffered)", bytes, events, nowSec() - start, checksum);
+    return 0;
+}
@@ -0,0 +1,87 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Micro-benchmark for the process queues: the per-event cost of the queue operations
+ *     used by the C, T, R and I events, as the ready queue grows from 10 to 1M processes
+ *
+ * Usage: ./queue_bench [max ready queue length] [operations per size]
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../pcb.h"
+
+// ================================================================================
+
+/**
+ * Helper that gets the current time in nanoseconds
+ * @return the monotonic clock's current time, in ns
+ */
+static double nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main( int argc, char *argv[] ) {
+    int maxLength = argc > 1 ? atoi(argv[1]) : 1000000;
+    int ops = argc > 2 ? atoi(argv[2]) : 2000000;
+    if(maxLength < 10 || ops < 1) {
+        fprintf(stderr, "Usage: %s [max ready queue length >= 10] [operations per size]\n", argv[0]);
+        return 1;
+    }
+
+    printf("%10s %14s %14s %14s %14s\n", "ready", "C ns/event", "T ns/event", "R ns/event", "I ns/event");
+    for(int length = 10; length <= maxLength; length *= 10) {
+        Queue ready, resource;
+        PIDIndex index;
+        PCBTable table;
+        initQueue(&ready);
+        initQueue(&resource);
+        initIndex(&index);
+        initTable(&table);
+
+        // C: allocate, index and enqueue every process
+        double start = nowNs();
+        for(int pid = 1; pid <= length; pid++) {
+            Slot p = createPCB(&table, 0, pid);
+            indexInsert(&index, pid, p);
+            pushBack(&table, &ready, p);
+        }
+        double create = (nowNs() - start) / length;
+
+        // T: preempt the running process to the back, run the front
+        start = nowNs();
+        for(int i = 0; i < ops; i++) {
+            pushBack(&table, &ready, popFront(&table, &ready));
+        }
+        double tick = (nowNs() - start) / ops;
+
+        // R: block a ready process somewhere in the middle of the queue
+        // I: unblock it again, back onto the end of the ready queue
+        unsigned int seed = 12345;
+        double block = 0, unblock = 0;
+        for(int i = 0; i < ops; i++) {
+            seed = seed * 1103515245u + 12345u;
+            int pid = 1 + (int)((seed >> 8) % (unsigned int)length);
+            start = nowNs();
+            pushBack(&table, &resource, popID(&table, &index, &ready, pid));
+            double mid = nowNs();
+            pushBack(&table, &ready, popID(&table, &index, &resource, pid));
+            unblock += nowNs() - mid;
+            block += mid - start;
+        }
+        printf("%10d %14.1f %14.1f %14.1f %14.1f\n", length, create, tick, block / ops, unblock / ops);
+
+        deleteQueue(&table, &ready);
+        deleteQueue(&table, &resource);
+        deleteIndex(&index);
+        deleteTable(&table);
+    }
+    return 0;
+}
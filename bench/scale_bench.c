@@ -0,0 +1,128 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Scaling benchmark: replays generated traces of 10^min to 10^max events through
+ *     ./idispatcher and records wall time, events/s and peak RSS for each size
+ *
+ * Usage: ./scale_bench [min exponent] [max exponent] [idispatcher options...]
+ * --> defaults to 10^3 to 10^8 events, run from the directory with idispatcher and tracegen
+ * --> each trace keeps up to 1% of its events' processes alive at once (at least 100), so
+ *     the queues and the index grow with the trace
+ * --> the cost per event should stay about flat as traces grow; a size whose ns/event is
+ *     more than 4x that of the first size of at least 10^4 events is flagged, and the
+ *     exit status is then 1
+ */
+
+// =================================== INCLUDES ===================================
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+#define GROWTH_LIMIT 4.0
+
+// ================================================================================
+
+/**
+ * Helper that gets the current time in seconds
+ * @return the monotonic clock's current time, in s
+ */
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/**
+ * Helper that runs a program with its stdout and stderr thrown away, and waits for it
+ * @param char **argv -the program and its arguments (NULL terminated)
+ * @param struct rusage *usage -will hold the resources it used
+ * @return 1 if it ran and exited with status 0, otherwise 0
+ */
+static int run(char **argv, struct rusage *usage) {
+    pid_t child = fork();
+    if(child < 0) {
+        return 0;
+    } else if(child == 0) {
+        int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        execv(argv[0], argv);
+        _exit(127);
+    }
+    int status;
+    if(wait4(child, &status, 0, usage) != child) {
+        return 0;
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// ================================================================================
+
+int main( int argc, char *argv[] ) {
+    int minExp = argc > 1 ? atoi(argv[1]) : 3;
+    int maxExp = argc > 2 ? atoi(argv[2]) : 8;
+    if(minExp < 1 || maxExp > 9 || minExp > maxExp) {
+        fprintf(stderr, "Usage: %s [min exponent] [max exponent] [idispatcher options...]\n", argv[0]);
+        return 1;
+    }
+    int numOptions = argc > 3 ? argc - 3 : 0;
+
+    printf("%12s %10s %14s %10s %10s %8s\n", "events", "wall s", "events/s", "ns/event", "RSS MB", "growth");
+    double baseline = 0;
+    int flagged = 0;
+    long long events = 1;
+    for(int i = 0; i < minExp; i++) {
+        events *= 10;
+    }
+    for(int exp = minExp; exp <= maxExp; exp++, events *= 10) {
+        // generate the trace
+        char path[64], eventsArg[32], processesArg[32];
+        snprintf(path, sizeof(path), "/tmp/idispatcher_scale_%d.bin", exp);
+        snprintf(eventsArg, sizeof(eventsArg), "--events=%lld", events);
+        snprintf(processesArg, sizeof(processesArg), "--processes=%lld", events / 100 < 100 ? 100 : events / 100);
+        char *genArgv[] = { "./tracegen", "--seed=3110", eventsArg, processesArg, "--format=bin", path, NULL };
+        struct rusage usage;
+        if(!run(genArgv, &usage)) {
+            fprintf(stderr, "Error: could not generate %s\n", path);
+            return 1;
+        }
+
+        // replay it
+        char **replayArgv = malloc((numOptions + 4) * sizeof(char*));
+        replayArgv[0] = "./idispatcher";
+        replayArgv[1] = "--input-format=bin";
+        for(int i = 0; i < numOptions; i++) {
+            replayArgv[2 + i] = argv[3 + i];
+        }
+        replayArgv[2 + numOptions] = path;
+        replayArgv[3 + numOptions] = NULL;
+        double start = nowSec();
+        int ok = run(replayArgv, &usage);
+        double wall = nowSec() - start;
+        free(replayArgv);
+        unlink(path);
+        if(!ok) {
+            fprintf(stderr, "Error: idispatcher failed on %s\n", path);
+            return 1;
+        }
+
+        // ru_maxrss is in KiB on Linux
+        double nsPerEvent = wall * 1e9 / events;
+        if(baseline == 0 && events >= 10000) {
+            baseline = nsPerEvent;
+        }
+        double growth = baseline > 0 ? nsPerEvent / baseline : 1.0;
+        printf("%12lld %10.3f %14.0f %10.1f %10.1f %7.2fx%s\n", events, wall, events / wall,
+               nsPerEvent, usage.ru_maxrss / 1024.0, growth, growth > GROWTH_LIMIT ? "  <-- regression?" : "");
+        fflush(stdout);
+        flagged |= growth > GROWTH_LIMIT;
+    }
+    return flagged;
+}
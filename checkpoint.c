@@ -0,0 +1,463 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Checkpoints: saves the whole dispatcher state (and where the input is up to) to a
+ *     file, so a run can be resumed from there later
+ * --> Saving and loading are linear in the state: every live process once (running, then
+ *     each ready queue in order, then each resource queue in order), then the finished
+ *     processes' times (only those sampled, with a sample size), then the latency
+ *     histograms' non-empty buckets, then the sample's totals and histograms
+ * --> A resumed run continues from the same input offset with the same setup and gives
+ *     the same output an uninterrupted run would (anything already streamed or snapshot
+ *     before the checkpoint isn't printed again)
+ * --> Format (all little-endian, sizes in bytes): "IDSPCKPT" magic (8), version (4), the
+ *     setup (policy 4, CPUs 4, balancing 4, resources 4, stream 4, snapshot interval 8,
+ *     latency 4, sample size 8), input format (4), trace version (4), offset (8), event
+ *     count (8), the dispatcher's times and counters (previous time 8, current time 8,
+ *     next CPU 4, next snapshot 8, finished 8), then each CPU (idle time 8, idle start 8,
+ *     running 1, then its process if it has one) and the rest of the processes as above,
+ *     ending with "IDSPDONE" so a cut off file is caught
+ * --> A process is its pid, state, CPU, resource, priority, MLFQ level and quantum used
+ *     (4 each), then its previous, run, ready and block times, run start, burst estimate,
+ *     burst base, sort key, sequence number and pass (8 each)
+ * --> The file is written beside the path first, then renamed over it, so a crash while
+ *     saving leaves the previous checkpoint as it was
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+
+#define CHECKPOINT_MAGIC "IDSPCKPT"
+#define CHECKPOINT_END "IDSPDONE"
+#define CHECKPOINT_VERSION 4        // version 1 had 32-bit times, version 2 had no sample size,
+                                    // version 3 had no idle start times
+
+// ================================== MY HELPERS ==================================
+
+/**
+ * Helper that writes an integer in little-endian order
+ * @param FILE *out -where to write it
+ * @param long long value -the integer
+ * @param int bytes -how many bytes to write it in (1-8)
+ */
+static void put(FILE *out, long long value, int bytes) {
+    unsigned char buffer[8];
+    for(int i = 0; i < bytes; i++) {
+        buffer[i] = (unsigned char)((unsigned long long)value >> (8 * i));
+    }
+    fwrite(buffer, 1, bytes, out);
+}
+
+/**
+ * Helper that reads an integer written by put
+ * @param FILE *in -where to read it from
+ * @param int bytes -how many bytes it was written in (1-8)
+ * @param int *ok -set to 0 if the file ends first
+ * @return the integer (sign-extended), or 0 if the file ended
+ */
+static long long get(FILE *in, int bytes, int *ok) {
+    unsigned char buffer[8];
+    if(fread(buffer, 1, bytes, in) != (size_t)bytes) {
+        *ok = 0;
+        return 0;
+    }
+    unsigned long long value = 0;
+    for(int i = 0; i < bytes; i++) {
+        value |= (unsigned long long)buffer[i] << (8 * i);
+    }
+    if(bytes < 8 && (value >> (8 * bytes - 1)) & 1) {
+        value |= ~0ULL << (8 * bytes);
+    }
+    return (long long)value;
+}
+
+/**
+ * Helper that writes everything about a live process
+ * @param FILE *out -where to write it
+ * @param PCBTable *t -the table it's in
+ * @param Slot s -the process
+ */
+static void putPCB(FILE *out, PCBTable *t, Slot s) {
+    PCBInfo *p = &t->info[s];
+    int fields[] = { t->pid[s], (int)t->status[s], p->cpu, p->resource, p->priority, p->level, p->quantumUsed };
+    long long times[] = { t->prevTime[s], t->runTime[s], t->readyTime[s], t->blockTime[s], p->runStart,
+                          p->burstEstimate, p->burstBase };
+    for(int i = 0; i < (int)(sizeof(fields) / sizeof(fields[0])); i++) {
+        put(out, fields[i], 4);
+    }
+    for(int i = 0; i < (int)(sizeof(times) / sizeof(times[0])); i++) {
+        put(out, times[i], 8);
+    }
+    put(out, p->sortKey, 8);
+    put(out, p->seq, 8);
+    put(out, p->pass, 8);
+}
+
+/**
+ * Helper that reads a live process written by putPCB into a new PCB, and indexes it
+ * --> its state, CPU, resource and MLFQ level must fit where it's being put back, since
+ *     they're used to index the CPUs, resources and queues
+ * @param FILE *in -where to read it from
+ * @param Dispatcher *d -the dispatcher it belongs to
+ * @param ProcessState status -the state it must be in
+ * @param int cpu -the CPU it must be on (-1 for any of them)
+ * @param int resource -the resource it must be blocked on (0 if it isn't blocked)
+ * @param int *ok -set to 0 if the file ends first, or any of that doesn't fit (saying which)
+ * @return the process (not in any queue yet)
+ */
+static Slot getPCB(FILE *in, Dispatcher *d, ProcessState status, int cpu, int resource, int *ok) {
+    PCBTable *t = &d->pcbs;
+    int pid = (int)get(in, 4, ok);
+    Slot s = createPCB(t, 0, pid);
+    PCBInfo *p = &t->info[s];
+    t->status[s] = (uint8_t)get(in, 4, ok);
+    p->cpu = (int)get(in, 4, ok);
+    p->resource = (int)get(in, 4, ok);
+    p->priority = (int)get(in, 4, ok);
+    p->level = (int)get(in, 4, ok);
+    p->quantumUsed = (int)get(in, 4, ok);
+    t->prevTime[s] = get(in, 8, ok);
+    t->runTime[s] = get(in, 8, ok);
+    t->readyTime[s] = get(in, 8, ok);
+    t->blockTime[s] = get(in, 8, ok);
+    p->runStart = get(in, 8, ok);
+    p->burstEstimate = get(in, 8, ok);
+    p->burstBase = get(in, 8, ok);
+    p->sortKey = get(in, 8, ok);
+    p->seq = get(in, 8, ok);
+    p->pass = get(in, 8, ok);
+    const char *invalid = NULL;
+    if(t->status[s] != status) {
+        invalid = "state";
+    } else if(p->cpu < 0 || p->cpu >= d->numCPUs || (cpu >= 0 && p->cpu != cpu)) {
+        invalid = "CPU";
+    } else if(p->resource != resource) {
+        invalid = "resource";
+    } else if(p->level < 0 || p->level >= d->policies[0].numLevels || p->quantumUsed < 0) {
+        invalid = "MLFQ level";
+    } else if(!indexInsert(&d->index, pid, s)) {
+        invalid = "ID (it's there twice)";
+    }
+    if(invalid != NULL && *ok) {
+        fprintf(stderr, "Error: checkpoint has process %d with an invalid %s\n", pid, invalid);
+        *ok = 0;
+    }
+    return s;
+}
+
+/**
+ * Helper that writes a histogram's non-empty buckets
+ * @param FILE *out -where to write it
+ * @param const Histogram *h -the histogram
+ */
+static void putHistogram(FILE *out, const Histogram *h) {
+    int used = 0;
+    for(int i = 0; i < HIST_BUCKETS; i++) {
+        used += h->counts[i] != 0;
+    }
+    put(out, h->total, 8);
+    put(out, h->max, 8);
+    put(out, used, 4);
+    for(int i = 0; i < HIST_BUCKETS; i++) {
+        if(h->counts[i] != 0) {
+            put(out, i, 4);
+            put(out, h->counts[i], 8);
+        }
+    }
+}
+
+/**
+ * Helper that reads a histogram written by putHistogram
+ * @param FILE *in -where to read it from
+ * @param Histogram *h -will hold the histogram (already initialized)
+ * @param int *ok -set to 0 if the file ends first or is invalid
+ */
+static void getHistogram(FILE *in, Histogram *h, int *ok) {
+    h->total = get(in, 8, ok);
+    h->max = get(in, 8, ok);
+    int used = (int)get(in, 4, ok);
+    for(int i = 0; i < used && *ok; i++) {
+        int bucket = (int)get(in, 4, ok);
+        long long count = get(in, 8, ok);
+        if(bucket < 0 || bucket >= HIST_BUCKETS) {
+            *ok = 0;
+        } else {
+            h->counts[bucket] = count;
+        }
+    }
+}
+
+// ============================= CHECKPOINT FUNCTIONS =============================
+
+/**
+ * Saves the dispatcher's state, and where the input is up to, to a checkpoint file
+ * --> the dispatcher's output is flushed first, since a resumed run doesn't print again
+ *     what was printed before the checkpoint
+ * @param const char *path -the checkpoint file (replaced once the new one is complete)
+ * @param Dispatcher *d -the dispatcher
+ * @param const EventReader *reader -the input being read (at the next event to apply)
+ * @param long long events -how many events have been read so far
+ * @return 1 if it was saved, otherwise 0
+ */
+int saveCheckpoint(const char *path, Dispatcher *d, const EventReader *reader, long long events) {
+    if(fflush(d->out) != 0) {
+        fprintf(stderr, "Error: could not write output before checkpoint %s\n", path);
+        return 0;
+    }
+    char *tempPath = malloc(strlen(path) + 5);
+    sprintf(tempPath, "%s.tmp", path);
+    FILE *out = fopen(tempPath, "wb");
+    if(out == NULL) {
+        fprintf(stderr, "Error: could not write checkpoint %s\n", tempPath);
+        free(tempPath);
+        return 0;
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 16);
+    PCBTable *t = &d->pcbs;
+
+    // header, setup and input position
+    fwrite(CHECKPOINT_MAGIC, 1, 8, out);
+    put(out, CHECKPOINT_VERSION, 4);
+    put(out, d->policies[0].kind, 4);
+    put(out, d->numCPUs, 4);
+    put(out, d->balance, 4);
+    put(out, d->numResources, 4);
+    put(out, d->stream, 4);
+    put(out, d->snapshotInterval, 8);
+    put(out, d->latency != NULL, 4);
+    put(out, d->sample != NULL ? d->sample->size : 0, 8);
+    put(out, reader->format, 4);
+    put(out, reader->version, 4);
+    put(out, readerOffset(reader), 8);
+    put(out, events, 8);
+
+    // times and counters
+    put(out, d->prevTime, 8);
+    put(out, d->currTime, 8);
+    put(out, d->nextCPU, 4);
+    put(out, d->nextSnapshot, 8);
+    put(out, d->numFinished, 8);
+
+    // every live process: running, then ready (in order), then blocked (in order)
+    for(int i = 0; i < d->numCPUs; i++) {
+        put(out, d->cpus[i].idleTime, 8);
+        put(out, d->cpus[i].idleSince, 8);
+        put(out, d->cpus[i].running != NO_SLOT, 1);
+        if(d->cpus[i].running != NO_SLOT) {
+            putPCB(out, t, d->cpus[i].running);
+        }
+    }
+    Slot *ready = NULL;
+    for(int i = 0; i < d->numCPUs; i++) {
+        Policy *policy = &d->policies[i];
+        put(out, policy->nextSeq, 8);
+        put(out, policy->ticks, 8);
+        put(out, policy->globalPass, 8);
+        put(out, policy->count, 4);
+        ready = realloc(ready, (policy->count + 1) * sizeof(Slot));
+        listReady(policy, ready);
+        for(int j = 0; j < policy->count; j++) {
+            putPCB(out, t, ready[j]);
+        }
+    }
+    free(ready);
+    for(int i = 1; i <= d->numResources; i++) {
+        put(out, d->resources[i].length, 4);
+        for(Slot curr = d->resources[i].head; curr != NO_SLOT; curr = t->next[curr]) {
+            putPCB(out, t, curr);
+        }
+    }
+
+    // finished processes' times (in the order they finished), then latency
+    put(out, d->finished.count, 4);
+    for(int i = 0; i < d->finished.count; i++) {
+        Slot p = d->finished.items[i];
+        put(out, t->pid[p], 4);
+        put(out, t->runTime[p], 8);
+        put(out, t->readyTime[p], 8);
+        put(out, t->blockTime[p], 8);
+    }
+    if(d->latency != NULL) {
+        putHistogram(out, &d->latency->wait);
+        putHistogram(out, &d->latency->burst);
+        putHistogram(out, &d->latency->blocked);
+        for(int i = 1; i <= d->numResources; i++) {
+            putHistogram(out, &d->latency->resources[i]);
+        }
+    }
+    if(d->sample != NULL) {
+        put(out, (long long)d->sample->random, 8);
+        put(out, d->sample->runTotal, 8);
+        put(out, d->sample->readyTotal, 8);
+        put(out, d->sample->blockTotal, 8);
+        putHistogram(out, &d->sample->run);
+        putHistogram(out, &d->sample->ready);
+        putHistogram(out, &d->sample->blocked);
+    }
+    fwrite(CHECKPOINT_END, 1, 8, out);
+
+    // only replace the last checkpoint once this one is safely written
+    int ok = fflush(out) == 0 && !ferror(out) && fsync(fileno(out)) == 0;
+    ok = (fclose(out) == 0) && ok;
+    ok = ok && rename(tempPath, path) == 0;
+    if(!ok) {
+        fprintf(stderr, "Error: could not write checkpoint %s\n", path);
+        unlink(tempPath);
+    }
+    free(tempPath);
+    return ok;
+}
+
+/**
+ * Loads a checkpoint: sets up the dispatcher as it was, and moves the input to where it was
+ * @param const char *path -the checkpoint file
+ * @param Dispatcher *d -will hold the dispatcher (not initialized yet, deleteDispatcher it after)
+ * @param EventReader *reader -the same input the checkpoint was saved from (nothing read yet)
+ * @param long long *events -will hold how many events had been read
+ * @return 1 if it was loaded, otherwise 0 (and d isn't initialized)
+ */
+int loadCheckpoint(const char *path, Dispatcher *d, EventReader *reader, long long *events) {
+    FILE *in = fopen(path, "rb");
+    if(in == NULL) {
+        fprintf(stderr, "Error: could not open checkpoint %s\n", path);
+        return 0;
+    }
+    setvbuf(in, NULL, _IOFBF, 1 << 16);
+    char magic[8];
+    int ok = 1;
+    if(fread(magic, 1, 8, in) != 8 || memcmp(magic, CHECKPOINT_MAGIC, 8) != 0
+            || get(in, 4, &ok) != CHECKPOINT_VERSION) {
+        fprintf(stderr, "Error: %s is not a checkpoint (version %d)\n", path, CHECKPOINT_VERSION);
+        fclose(in);
+        return 0;
+    }
+
+    // setup and input position
+    DispatcherConfig config;
+    defaultConfig(&config);
+    config.policy = (PolicyKind)get(in, 4, &ok);
+    config.numCPUs = (int)get(in, 4, &ok);
+    config.balance = (BalanceKind)get(in, 4, &ok);
+    config.numResources = (int)get(in, 4, &ok);
+    config.stream = (int)get(in, 4, &ok);
+    config.snapshotInterval = get(in, 8, &ok);
+    config.latency = (int)get(in, 4, &ok);
+    config.sample = get(in, 8, &ok);
+    InputFormat format = (InputFormat)get(in, 4, &ok);
+    int traceVersion = (int)get(in, 4, &ok);
+    long long offset = get(in, 8, &ok);
+    *events = get(in, 8, &ok);
+    if(!ok || config.numCPUs < 1 || config.numCPUs > MAX_CPUS || config.numResources < 1
+            || config.numResources > MAX_RESOURCES || (int)config.policy < 0
+            || config.policy > STRIDE_POLICY || (int)config.balance < 0 || config.balance > STEAL_BALANCE
+            || config.sample < 0) {
+        fprintf(stderr, "Error: checkpoint %s is corrupt\n", path);
+        fclose(in);
+        return 0;
+    }
+    if(format != reader->format) {
+        fprintf(stderr, "Error: checkpoint %s was saved from a %s input\n", path, format == BINARY_FORMAT ? "bin" : "text");
+        fclose(in);
+        return 0;
+    }
+
+    // times and counters
+    initDispatcher(d, &config);
+    d->prevTime = get(in, 8, &ok);
+    d->currTime = get(in, 8, &ok);
+    d->nextCPU = (int)get(in, 4, &ok);
+    d->nextSnapshot = get(in, 8, &ok);
+    d->numFinished = (long)get(in, 8, &ok);
+    if(d->nextCPU < 0 || d->nextCPU >= d->numCPUs || d->numFinished < 0) {
+        ok = 0;
+    }
+
+    // every live process, put back where it was
+    for(int i = 0; i < d->numCPUs && ok; i++) {
+        d->cpus[i].idleTime = get(in, 8, &ok);
+        d->cpus[i].idleSince = get(in, 8, &ok);
+        if(get(in, 1, &ok)) {
+            d->cpus[i].running = getPCB(in, d, RUNNING, i, 0, &ok);
+        }
+    }
+    for(int i = 0; i < d->numCPUs && ok; i++) {
+        Policy *policy = &d->policies[i];
+        policy->nextSeq = get(in, 8, &ok);
+        policy->ticks = get(in, 8, &ok);
+        policy->globalPass = get(in, 8, &ok);
+        int count = (int)get(in, 4, &ok);
+        for(int j = 0; j < count && ok; j++) {
+            Slot p = getPCB(in, d, READY, d->balance == GLOBAL_BALANCE ? -1 : i, 0, &ok);
+            if(ok) {
+                restoreReady(policy, p);
+            }
+        }
+    }
+    for(int i = 1; i <= d->numResources && ok; i++) {
+        int length = (int)get(in, 4, &ok);
+        for(int j = 0; j < length && ok; j++) {
+            Slot p = getPCB(in, d, BLOCKED, -1, i, &ok);
+            if(ok) {
+                pushBack(&d->pcbs, &d->resources[i], p);
+            }
+        }
+    }
+
+    // finished processes' times, then latency
+    int finished = (int)get(in, 4, &ok);
+    if(finished < 0 || finished > d->numFinished || (d->sample != NULL && finished > d->sample->size)) {
+        ok = 0;
+    }
+    for(int i = 0; i < finished && ok; i++) {
+        PCBTable *t = &d->pcbs;
+        Slot p = createPCB(t, 0, (int)get(in, 4, &ok));
+        t->runTime[p] = get(in, 8, &ok);
+        t->readyTime[p] = get(in, 8, &ok);
+        t->blockTime[p] = get(in, 8, &ok);
+        t->status[p] = TERMINATED;
+        append(&d->finished, p);
+    }
+    if(d->latency != NULL && ok) {
+        getHistogram(in, &d->latency->wait, &ok);
+        getHistogram(in, &d->latency->burst, &ok);
+        getHistogram(in, &d->latency->blocked, &ok);
+        for(int i = 1; i <= d->numResources && ok; i++) {
+            getHistogram(in, &d->latency->resources[i], &ok);
+        }
+    }
+    if(d->sample != NULL && ok) {
+        d->sample->random = (unsigned long long)get(in, 8, &ok);
+        d->sample->runTotal = get(in, 8, &ok);
+        d->sample->readyTotal = get(in, 8, &ok);
+        d->sample->blockTotal = get(in, 8, &ok);
+        getHistogram(in, &d->sample->run, &ok);
+        getHistogram(in, &d->sample->ready, &ok);
+        getHistogram(in, &d->sample->blocked, &ok);
+    }
+    if(ok && (fread(magic, 1, 8, in) != 8 || memcmp(magic, CHECKPOINT_END, 8) != 0)) {
+        ok = 0;
+    }
+    fclose(in);
+    if(!ok) {
+        fprintf(stderr, "Error: checkpoint %s is corrupt or cut off\n", path);
+        deleteDispatcher(d);
+        return 0;
+    }
+
+    // continue the input from where it was
+    reader->version = traceVersion;
+    if(!seekReader(reader, offset)) {
+        fprintf(stderr, "Error: input is shorter than when checkpoint %s was saved\n", path);
+        deleteDispatcher(d);
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,20 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Checkpoints: saves the whole dispatcher state (and where the input is up to) to a
+ *     file, so a run can be resumed from there later
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "events.h"
+#include "dispatcher.h"
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+int saveCheckpoint(const char *path, Dispatcher *d, const EventReader *reader, long long events);
+int loadCheckpoint(const char *path, Dispatcher *d, EventReader *reader, long long *events);
+
+#endif
@@ -0,0 +1,381 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Daemon mode: takes events as they arrive and answers queries on a local control socket
+ * --> The input (a pipe, FIFO, file or stdin) is read without blocking, and every event
+ *     that has fully arrived is applied at once, so queries are answered between reads
+ *     without stopping the input; the results are printed as usual once the input ends
+ * --> Queries are one per line on a Unix domain socket, and each gets a one line answer:
+ *         pid <n>      -> pid=<n> status=<state> cpu=<n> resource=<n> run=<t> ready=<t> blocked=<t>
+ *                         (times so far, up to the last event), or pid=<n> not alive
+ *         totals       -> a snapshot line (see printSnapshot) followed by
+ *                         events=<n applied so far>
+ *         shutdown     -> ok, then the input stops being read and the results are printed
+ * --> Clients never hold up the input: their sockets don't block, answers a client isn't
+ *     reading yet wait in its own buffer (sent as the socket has room), and once that's
+ *     full its queries aren't read until it catches up
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "daemon.h"
+
+#define MAX_CLIENTS 16
+#define COMMAND_SIZE 256
+#define REPLY_LIMIT (1 << 20)   // unsent answers a client can have before its queries wait
+
+// =================================== STRUCTS ====================================
+
+/**
+ * A connection on the control socket, the part of a query it has sent so far, and the
+ * answers it hasn't been sent yet
+ */
+typedef struct client_struct {
+    int fd;
+    char command[COMMAND_SIZE];
+    size_t length;
+    char *reply;
+    size_t replyLength;
+    int done;           // 1 once it's sent everything (closed once its answers are sent)
+} Client;
+
+// ================================== MY HELPERS ==================================
+
+/**
+ * Helper that starts listening on the control socket (replacing a stale one)
+ * @param const char *socketPath -where the socket goes
+ * @return the listening socket, or -1 if it couldn't be set up
+ */
+static int listenOn(const char *socketPath) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if(strlen(socketPath) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Error: socket path %s is too long\n", socketPath);
+        return -1;
+    }
+    strcpy(address.sun_path, socketPath);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0) {
+        return -1;
+    }
+    unlink(socketPath);
+    if(bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, MAX_CLIENTS) != 0) {
+        fprintf(stderr, "Error: could not listen on socket %s\n", socketPath);
+        close(fd);
+        return -1;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    return fd;
+}
+
+/**
+ * Helper that gets a process state's name
+ * @param ProcessState status -the state
+ * @return its name
+ */
+static const char* stateName(ProcessState status) {
+    switch(status) {
+        case NEW:        return "NEW";
+        case RUNNING:    return "RUNNING";
+        case READY:      return "READY";
+        case BLOCKED:    return "BLOCKED";
+        default:         return "TERMINATED";
+    }
+}
+
+/**
+ * Helper that answers one query
+ * @param Dispatcher *d -the dispatcher
+ * @param long long events -how many events have been applied so far
+ * @param const char *command -the query (without its '\n')
+ * @param FILE *out -where the answer goes
+ * @return 1 if it was a shutdown, otherwise 0
+ */
+static int answer(Dispatcher *d, long long events, const char *command, FILE *out) {
+    int pid;
+    if(sscanf(command, "pid %d", &pid) == 1) {
+        PCBTable *t = &d->pcbs;
+        Slot p = indexFind(&d->index, pid);
+        if(p == NO_SLOT) {
+            fprintf(out, "pid=%d not alive\n", pid);
+            return 0;
+        }
+        // count the time since its last change as well (in whatever state it's in)
+        long long since = d->currTime - t->prevTime[p];
+        fprintf(out, "pid=%d status=%s cpu=%d resource=%d run=%lld ready=%lld blocked=%lld\n",
+                pid, stateName((ProcessState)t->status[p]), t->info[p].cpu, t->info[p].resource,
+                t->runTime[p] + (t->status[p] == RUNNING ? since : 0),
+                t->readyTime[p] + (t->status[p] == READY ? since : 0),
+                t->blockTime[p] + (t->status[p] == BLOCKED ? since : 0));
+    } else if(strcmp(command, "totals") == 0) {
+        printSnapshot(d, d->currTime, out);
+        fprintf(out, "events=%lld\n", events);
+    } else if(strcmp(command, "shutdown") == 0) {
+        fprintf(out, "ok\n");
+        return 1;
+    } else {
+        fprintf(out, "error: unknown query (pid <n>, totals or shutdown)\n");
+    }
+    return 0;
+}
+
+/**
+ * Helper that closes a client's connection, dropping anything it hasn't been sent
+ * @param Client *client -the client (its fd is set to -1)
+ */
+static void closeClient(Client *client) {
+    close(client->fd);
+    client->fd = -1;
+    client->length = 0;
+    free(client->reply);
+    client->reply = NULL;
+    client->replyLength = 0;
+    client->done = 0;
+}
+
+/**
+ * Helper that sends as much of a client's answers as its socket has room for
+ * @param Client *client -the client (closed if the connection is broken)
+ */
+static void flushClient(Client *client) {
+    size_t sent = 0;
+    while(sent < client->replyLength) {
+        ssize_t w = send(client->fd, client->reply + sent, client->replyLength - sent, MSG_NOSIGNAL);
+        if(w < 0 && errno == EINTR) {
+            continue;
+        } else if(w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        } else if(w <= 0) {
+            closeClient(client);
+            return;
+        }
+        sent += w;
+    }
+    client->replyLength -= sent;
+    memmove(client->reply, client->reply + sent, client->replyLength);
+}
+
+/**
+ * Helper that reads what a client has sent, answering each whole query in it, then sends
+ * as much of its answers as it can
+ * @param Client *client -the client (its fd is closed and set to -1 once it's done)
+ * @param Dispatcher *d -the dispatcher
+ * @param long long events -how many events have been applied so far
+ * @param short revents -what poll said is ready on its socket
+ * @return 1 if it asked to shut down, otherwise 0
+ */
+static int serveClient(Client *client, Dispatcher *d, long long events, short revents) {
+    int shutdown = 0;
+    ssize_t n = -1;
+    if(!client->done && (revents & (POLLIN | POLLHUP | POLLERR))) {
+        n = read(client->fd, client->command + client->length, COMMAND_SIZE - client->length);
+        // the client is done once it closes its end (or something went wrong)
+        if(n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+            client->done = 1;
+        }
+    }
+
+    // answer every whole line (the answers are gathered, then added to what's unsent)
+    if(n > 0) {
+        client->length += n;
+        char *reply = NULL;
+        size_t replySize = 0;
+        FILE *out = open_memstream(&reply, &replySize);
+        char *newline;
+        while(out != NULL && (newline = memchr(client->command, '\n', client->length)) != NULL) {
+            *newline = '\0';
+            if(newline > client->command && newline[-1] == '\r') {
+                newline[-1] = '\0';
+            }
+            shutdown |= answer(d, events, client->command, out);
+            client->length -= newline + 1 - client->command;
+            memmove(client->command, newline + 1, client->length);
+        }
+        if(out != NULL && client->length == COMMAND_SIZE) {
+            fprintf(out, "error: query too long\n");
+            client->done = 1;
+        }
+        if(out != NULL) {
+            fclose(out);
+            client->reply = realloc(client->reply, client->replyLength + replySize);
+            memcpy(client->reply + client->replyLength, reply, replySize);
+            client->replyLength += replySize;
+            free(reply);
+        }
+    }
+
+    if(client->replyLength > 0) {
+        flushClient(client);
+    }
+    if(client->fd >= 0 && client->done && client->replyLength == 0) {
+        closeClient(client);
+    }
+    return shutdown;
+}
+
+// =============================== DAEMON FUNCTIONS ===============================
+
+/**
+ * Runs as a daemon: applies events as they arrive while answering queries, until the
+ * input ends or a shutdown query, then prints the results to stdout
+ * @param const char *socketPath -where the control socket goes (removed once done)
+ * @param const char *inputPath -the input (e.g. a FIFO), or NULL or "-" for stdin
+ * @param InputFormat format -whether the input is text lines or a binary trace
+ * @param const DispatcherConfig *config -how the dispatcher is set up
+ * @return 0 if it ran, otherwise 1
+ */
+int runDaemon(const char *socketPath, const char *inputPath, InputFormat format,
+              const DispatcherConfig *config) {
+    // listen first, so queries can queue up while waiting for a FIFO's writer to open it
+    int listener = listenOn(socketPath);
+    if(listener < 0) {
+        return 1;
+    }
+    int fd = STDIN_FILENO;
+    if(inputPath != NULL && strcmp(inputPath, "-") != 0 && (fd = open(inputPath, O_RDONLY)) < 0) {
+        fprintf(stderr, "Error: could not open input file %s\n", inputPath);
+        close(listener);
+        unlink(socketPath);
+        return 1;
+    }
+    int oldFlags = fcntl(fd, F_GETFL);
+    fcntl(fd, F_SETFL, oldFlags | O_NONBLOCK);
+
+    EventReader reader;
+    openReaderFd(&reader, fd, format);
+    reader.ownsFd = (fd != STDIN_FILENO);
+    Dispatcher d;
+    initDispatcher(&d, config);
+
+    Client clients[MAX_CLIENTS];
+    for(int i = 0; i < MAX_CLIENTS; i++) {
+        clients[i].fd = -1;
+        clients[i].length = 0;
+        clients[i].reply = NULL;
+        clients[i].replyLength = 0;
+        clients[i].done = 0;
+    }
+    struct pollfd fds[MAX_CLIENTS + 2];
+    long long events = 0;
+    int ended = 0;
+    while(!ended) {
+        // wait for input, a new client, a query, or room to send a client's answers
+        fds[0].fd = fd;
+        fds[1].fd = listener;
+        for(int i = 0; i < MAX_CLIENTS + 2; i++) {
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        for(int i = 0; i < MAX_CLIENTS; i++) {
+            fds[i+2].fd = clients[i].fd;
+            fds[i+2].events = (clients[i].done || clients[i].replyLength >= REPLY_LIMIT ? 0 : POLLIN)
+                              | (clients[i].replyLength > 0 ? POLLOUT : 0);
+        }
+        if(poll(fds, MAX_CLIENTS + 2, -1) < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "Error: could not wait for input\n");
+            break;
+        }
+
+        // apply every event that has fully arrived
+        if(fds[0].revents != 0 && fillReader(&reader) != -1) {
+            Event next;
+            int status;
+            while((status = pollEvent(&reader, &next)) == 1) {
+                processEvent(&d, &next);
+                events++;
+            }
+            ended = (status == -1);
+        }
+
+        // take new clients
+        if(fds[1].revents & POLLIN) {
+            int client;
+            while((client = accept(listener, NULL, NULL)) >= 0) {
+                int i = 0;
+                while(i < MAX_CLIENTS && clients[i].fd >= 0) {
+                    i++;
+                }
+                if(i == MAX_CLIENTS) {
+                    send(client, "error: too many clients\n", 24, MSG_NOSIGNAL);
+                    close(client);
+                } else {
+                    fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+                    clients[i].fd = client;
+                    clients[i].length = 0;
+                }
+            }
+        }
+
+        // answer queries
+        for(int i = 0; i < MAX_CLIENTS; i++) {
+            if(clients[i].fd >= 0 && fds[i+2].fd == clients[i].fd && fds[i+2].revents != 0) {
+                ended |= serveClient(&clients[i], &d, events, fds[i+2].revents);
+            }
+        }
+    }
+
+    // display program output, then clean up (sending what answers there's room for)
+    printResults(&d, stdout);
+    for(int i = 0; i < MAX_CLIENTS; i++) {
+        if(clients[i].fd >= 0 && clients[i].replyLength > 0) {
+            flushClient(&clients[i]);
+        }
+        if(clients[i].fd >= 0) {
+            closeClient(&clients[i]);
+        }
+    }
+    close(listener);
+    unlink(socketPath);
+    fcntl(fd, F_SETFL, oldFlags);
+    closeReader(&reader);
+    deleteDispatcher(&d);
+    return 0;
+}
+
+/**
+ * Sends one query to a daemon and prints its answer
+ * @param const char *socketPath -the daemon's control socket
+ * @param const char *command -the query
+ * @return 0 if it was answered, otherwise 1
+ */
+int queryDaemon(const char *socketPath, const char *command) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath, sizeof(address.sun_path) - 1);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0 || connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        fprintf(stderr, "Error: could not connect to %s\n", socketPath);
+        if(fd >= 0) close(fd);
+        return 1;
+    }
+
+    // send the query, then print everything until the daemon closes the connection
+    size_t length = strlen(command);
+    int ok = write(fd, command, length) == (ssize_t)length && write(fd, "\n", 1) == 1;
+    shutdown(fd, SHUT_WR);
+    char buffer[4096];
+    ssize_t n;
+    while(ok && (n = read(fd, buffer, sizeof(buffer))) > 0) {
+        fwrite(buffer, 1, n, stdout);
+    }
+    close(fd);
+    return !ok;
+}
@@ -0,0 +1,20 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Daemon mode: takes events as they arrive and answers queries on a local control socket
+ */
+
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "events.h"
+#include "dispatcher.h"
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+int runDaemon(const char *socketPath, const char *inputPath, InputFormat format,
+              const DispatcherConfig *config);
+int queryDaemon(const char *socketPath, const char *command);
+
+#endif
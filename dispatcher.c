@@ -0,0 +1,902 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> The dispatcher's state, and how each event changes it
+ * --> With more than one CPU, a timer interrupt happens on every CPU (in CPU order), and a
+ *     new or unblocked process goes to an idle CPU if there is one (the one it last ran on
+ *     first, then the lowest numbered), otherwise to a ready queue (see BalanceKind)
+ * --> When streaming, a process's times are printed (same format) as soon as it exits and
+ *     its PCB is freed, so memory depends on how many processes are alive, not on how many
+ *     there have been; the idle time line comes last instead of first, once input ends
+ * --> With a snapshot interval, a snapshot line (see printSnapshot) is printed for the state
+ *     at the most recent multiple of the interval each time an event crosses one (the state
+ *     just before that event, idle time as counted so far)
+ * --> With a sample size, only that many finished processes are kept (a reservoir sample,
+ *     see keepSample), so memory depends on how many processes are alive and the sample
+ *     size; idle time and the totals over every finished process are still exact, and
+ *     their distributions are within a histogram bucket (see histogram.h)
+ * --> Events can be applied a batch at a time (see processEvents), where a run of timer
+ *     interrupts that can't change who runs (every ready queue is empty, and the policy
+ *     keeps no per-tick state) is applied as a single time accounting step
+ */
+
+// =================================== INCLUDES ===================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "dispatcher.h"
+#include "stats.h"
+
+/**
+ * The kinds of event (the columns of the transition table, see processEvent)
+ */
+typedef enum event_kind { CREATE_EVENT, EXIT_EVENT, REQUEST_EVENT, INTERRUPT_EVENT, TIMER_EVENT,
+                          INVALID_EVENT, NUM_EVENT_KINDS } EventKind;
+
+// ============================== DISPATCH FUNCTIONS ==============================
+
+/**
+ * Helper that gets the ready queue a CPU runs processes from
+ * @param Dispatcher *d -the dispatcher
+ * @param int cpu -the CPU
+ * @return its ready queue (the shared one if balancing is global)
+ */
+static Policy* readyQueueOf(Dispatcher *d, int cpu) {
+    return d->balance == GLOBAL_BALANCE ? &d->policies[0] : &d->policies[cpu];
+}
+
+/**
+ * Helper that changes a process's state, tracing the transition if they're being traced
+ * @param Dispatcher *d -the dispatcher
+ * @param Slot p -the process (its cpu and resource already as they are in the new state)
+ * @param ProcessState status -its new state
+ */
+static void setStatus(Dispatcher *d, Slot p, ProcessState status) {
+    PCBTable *t = &d->pcbs;
+    if(d->trace != NULL) {
+        traceTransition(d->trace, d->currTime, t->pid[p], (ProcessState)t->status[p], status,
+                        t->info[p].resource, t->info[p].cpu);
+    }
+    t->status[p] = status;
+}
+
+/**
+ * Helper that records how long a process just ran for, if latency is being recorded
+ * @param Dispatcher *d -the dispatcher
+ * @param Slot p -the process that just stopped running
+ */
+static void recordBurst(Dispatcher *d, Slot p) {
+    if(d->latency != NULL) {
+        recordValue(&d->latency->burst, d->currTime - d->pcbs.info[p].runStart);
+    }
+}
+
+/**
+ * Helper that records how long a process was blocked, if latency is being recorded
+ * @param Dispatcher *d -the dispatcher
+ * @param Slot p -the process that's no longer blocked (before its times are updated)
+ */
+static void recordBlocked(Dispatcher *d, Slot p) {
+    PCBTable *t = &d->pcbs;
+    if(d->latency != NULL) {
+        recordValue(&d->latency->blocked, d->currTime - t->prevTime[p]);
+        recordValue(&d->latency->resources[t->info[p].resource], d->currTime - t->prevTime[p]);
+    }
+}
+
+/**
+ * Helper that charges a process for the time since it was last charged, to its total
+ * time in the state it's been in (running, ready or blocked)
+ * @param Dispatcher *d -the dispatcher
+ * @param Slot p -the process (still in that state)
+ */
+static void account(Dispatcher *d, Slot p) {
+    STAT_START(start);
+    PCBTable *t = &d->pcbs;
+    long long elapsed = d->currTime - t->prevTime[p];
+    if(t->status[p] == RUNNING) {
+        t->runTime[p] += elapsed;
+    } else if(t->status[p] == READY) {
+        t->readyTime[p] += elapsed;
+    } else {
+        recordBlocked(d, p);
+        t->blockTime[p] += elapsed;
+    }
+    t->prevTime[p] = d->currTime;
+    STAT_STOP(ACCOUNT_PHASE, start);
+}
+
+/**
+ * Helper that charges an idle CPU (its system idle process)
+ * --> with one CPU, for the time since the previous event (as the original dispatcher
+ *     did, so its output is unchanged); with more, for the time since that CPU was last
+ *     charged or went idle, so events on other CPUs in between don't lose any of it
+ * @param Dispatcher *d -the dispatcher
+ * @param int cpu -the CPU (running nothing)
+ */
+static void chargeIdle(Dispatcher *d, int cpu) {
+    STAT_START(start);
+    if(d->numCPUs == 1) {
+        d->cpus[cpu].idleTime += d->currTime - d->prevTime;
+    } else {
+        d->cpus[cpu].idleTime += d->currTime - d->cpus[cpu].idleSince;
+    }
+    d->cpus[cpu].idleSince = d->currTime;
+    STAT_STOP(ACCOUNT_PHASE, start);
+}
+
+/**
+ * Helper that has a process that was ready start running on a CPU
+ * @param Dispatcher *d -the dispatcher
+ * @param int cpu -the CPU it runs on (idle, or whatever it was running just stopped)
+ * @param Slot toRun -the process, already out of its ready queue
+ */
+static void startRunning(Dispatcher *d, int cpu, Slot toRun) {
+    PCBTable *t = &d->pcbs;
+    if(d->cpus[cpu].running == NO_SLOT) {
+        chargeIdle(d, cpu);
+    }
+    // update total ready time first
+    if(d->latency != NULL) {
+        recordValue(&d->latency->wait, d->currTime - t->prevTime[toRun]);
+    }
+    account(d, toRun);
+    // have it run
+    t->info[toRun].cpu = cpu;
+    t->info[toRun].runStart = d->currTime;
+    setStatus(d, toRun, RUNNING);
+    d->cpus[cpu].running = toRun;
+}
+
+/**
+ * Helper that runs whatever the policy picks next on a CPU that just stopped running
+ * --> with work stealing, a CPU with nothing ready takes a process from the busiest CPU
+ * @param Dispatcher *d -the dispatcher
+ * @param int cpu -the CPU (it's left idle if nothing is ready)
+ */
+static void runNext(Dispatcher *d, int cpu) {
+    Slot toRun = pickNext(readyQueueOf(d, cpu));
+    if(toRun == NO_SLOT && d->balance == STEAL_BALANCE) {
+        int busiest = 0;
+        for(int i = 1; i < d->numCPUs; i++) {
+            if(d->policies[i].count > d->policies[busiest].count) {
+                busiest = i;
+            }
+        }
+        toRun = pickNext(&d->policies[busiest]);
+    }
+    if(toRun != NO_SLOT) {
+        startRunning(d, cpu, toRun);
+    } else if(d->cpus[cpu].running != NO_SLOT) {
+        d->cpus[cpu].running = NO_SLOT;
+        d->cpus[cpu].idleSince = d->currTime;
+    }
+}
+
+/**
+ * Helper that gets an idle CPU
+ * @param Dispatcher *d -the dispatcher
+ * @param int preferred -the CPU to use if it's idle (-1 for none)
+ * @return the preferred CPU if it's idle, otherwise the lowest numbered idle CPU,
+ *          or -1 if none are idle
+ */
+static int idleCPU(Dispatcher *d, int preferred) {
+    if(preferred >= 0 && d->cpus[preferred].running == NO_SLOT) {
+        return preferred;
+    }
+    for(int i = 0; i < d->numCPUs; i++) {
+        if(d->cpus[i].running == NO_SLOT) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Helper that gets the CPU whose ready queue a process should wait in
+ * @param Dispatcher *d -the dispatcher
+ * @param Slot p -the process (cpu is the one it last ran on, or -1 if it's new)
+ * @return the CPU (always 0 if balancing is global)
+ */
+static int queueFor(Dispatcher *d, Slot p) {
+    if(d->balance == GLOBAL_BALANCE) {
+        return 0;
+    } else if(d->balance == STEAL_BALANCE) {
+        if(d->pcbs.info[p].cpu >= 0) {
+            return d->pcbs.info[p].cpu;
+        }
+        d->nextCPU = (d->nextCPU + 1) % d->numCPUs;
+        return d->nextCPU;
+    }
+    // push: least loaded
+    int least = 0;
+    for(int i = 1; i < d->numCPUs; i++) {
+        if(d->policies[i].count < d->policies[least].count) {
+            least = i;
+        }
+    }
+    return least;
+}
+
+/**
+ * Helper that has a process that was just created or unblocked run, or wait until it can
+ * @param Dispatcher *d -the dispatcher
+ * @param Slot p -the process
+ */
+static void admit(Dispatcher *d, Slot p) {
+    PCBTable *t = &d->pcbs;
+    // if a CPU is idle, update its idle time and make it run there
+    int cpu = idleCPU(d, t->info[p].cpu);
+    if(cpu >= 0) {
+        chargeIdle(d, cpu);
+        if(d->latency != NULL) {
+            recordValue(&d->latency->wait, 0);
+        }
+        t->info[p].cpu = cpu;
+        t->info[p].runStart = d->currTime;
+        setStatus(d, p, RUNNING);
+        d->cpus[cpu].running = p;
+    }
+    // otherwise, add it to a ready queue
+    else {
+        t->info[p].cpu = queueFor(d, p);
+        setStatus(d, p, READY);
+        enqueueReady(readyQueueOf(d, t->info[p].cpu), p);
+    }
+}
+
+/**
+ * Helper that moves ready processes from the busiest CPUs to the least loaded ones (push)
+ * --> a CPU's load is its ready processes plus its running one, and processes are moved
+ *     until no two loads differ by more than one (at most one move per CPU per call)
+ * @param Dispatcher *d -the dispatcher
+ */
+static void rebalance(Dispatcher *d) {
+    PCBTable *t = &d->pcbs;
+    for(int moves = 0; moves < d->numCPUs; moves++) {
+        int busiest = -1, least = 0;
+        int busiestLoad = 0, leastLoad = 0;
+        for(int i = 0; i < d->numCPUs; i++) {
+            int load = d->policies[i].count + (d->cpus[i].running != NO_SLOT);
+            if(d->policies[i].count > 0 && (busiest < 0 || load > busiestLoad)) {
+                busiest = i;
+                busiestLoad = load;
+            }
+            if(i == 0 || load < leastLoad) {
+                least = i;
+                leastLoad = load;
+            }
+        }
+        if(busiest < 0 || busiestLoad - leastLoad <= 1) {
+            return;
+        }
+
+        Slot moved = pickNext(&d->policies[busiest]);
+        if(d->cpus[least].running == NO_SLOT) {
+            startRunning(d, least, moved);
+        } else {
+            t->info[moved].cpu = least;
+            enqueueReady(&d->policies[least], moved);
+        }
+    }
+}
+
+/**
+ * Helper that blocks a process on a resource
+ * @param Dispatcher *d -the dispatcher
+ * @param Slot p -the process (not in any queue anymore)
+ * @param int resourceNum -the resource it's waiting for
+ */
+static void block(Dispatcher *d, Slot p, int resourceNum) {
+    PCBTable *t = &d->pcbs;
+    t->info[p].resource = resourceNum;
+    setStatus(d, p, BLOCKED);
+    pushBack(t, &d->resources[resourceNum], p);
+}
+
+/**
+ * Helper that counts a finished process towards the sample's totals and distributions,
+ * and keeps it in the sample or frees it (reservoir sampling: the n-th one to finish
+ * replaces a random kept one with probability size/n)
+ * @param Dispatcher *d -the dispatcher (numFinished already counting the process)
+ * @param Slot done -the process (not in any queue anymore)
+ */
+static void keepSample(Dispatcher *d, Slot done) {
+    PCBTable *t = &d->pcbs;
+    Sample *s = d->sample;
+    s->runTotal += t->runTime[done];
+    s->readyTotal += t->readyTime[done];
+    s->blockTotal += t->blockTime[done];
+    recordValue(&s->run, t->runTime[done]);
+    recordValue(&s->ready, t->readyTime[done]);
+    recordValue(&s->blocked, t->blockTime[done]);
+    if(d->finished.count < s->size) {
+        append(&d->finished, done);
+        return;
+    }
+    // xorshift64*
+    s->random ^= s->random >> 12;
+    s->random ^= s->random << 25;
+    s->random ^= s->random >> 27;
+    unsigned long long j = (s->random * 2685821657736338717ULL) % (unsigned long long)d->numFinished;
+    if(j < (unsigned long long)s->size) {
+        deletePCB(t, d->finished.items[j]);
+        d->finished.items[j] = done;
+    } else {
+        deletePCB(t, done);
+    }
+}
+
+/**
+ * Helper that moves a process to the finished list
+ * @param Dispatcher *d -the dispatcher
+ * @param Slot done -the process (not in any queue anymore)
+ */
+static void terminate(Dispatcher *d, Slot done) {
+    PCBTable *t = &d->pcbs;
+    setStatus(d, done, TERMINATED);
+    indexRemove(&d->index, t->pid[done]);
+    d->numFinished++;
+    if(d->stream) {
+        fprintf(d->out, "%d %lld %lld %lld\n", t->pid[done], t->runTime[done], t->readyTime[done], t->blockTime[done]);
+        deletePCB(t, done);
+    } else if(d->sample != NULL) {
+        keepSample(d, done);
+    } else {
+        append(&d->finished, done);
+    }
+}
+
+// ============================= TRANSITION FUNCTIONS =============================
+// --> one for each (state, event) pair in the transition table (see processEvent), each
+//     given the event and its process (NO_SLOT if no live process has its ID)
+
+typedef void (*EventHandler)(Dispatcher *d, const Event *event, Slot p);
+
+/**
+ * Helper that takes a waiting process out of the ready or resource queue it's in, and
+ * charges it for the time it waited
+ * @param Dispatcher *d -the dispatcher
+ * @param Slot p -the process (ready or blocked)
+ */
+static void stopWaiting(Dispatcher *d, Slot p) {
+    PCBTable *t = &d->pcbs;
+    if(t->status[p] == READY) {
+        removeReady(readyQueueOf(d, t->info[p].cpu), p);
+    } else {
+        removePCB(t, &d->resources[t->info[p].resource], p);
+    }
+    account(d, p);
+}
+
+/**
+ * C with no such process: creates it, then runs it or adds it to a ready queue
+ */
+static void create(Dispatcher *d, const Event *event, Slot p) {
+    PCBTable *t = &d->pcbs;
+    Slot newPCB = createPCB(t, d->currTime, event->pid);
+    t->info[newPCB].priority = event->priority;
+    indexInsert(&d->index, event->pid, newPCB);
+    admit(d, newPCB);
+}
+/**
+ * C for a process that already exists: ignored
+ */
+static void createExisting(Dispatcher *d, const Event *event, Slot p) {
+    fprintf(d->log, "Error: process ID %d already exists - input line will be ignored\n", event->pid);
+}
+
+/**
+ * E for a running process: puts it in the finished list, then runs whatever the policy
+ * picks next on its CPU, if anything
+ */
+static void exitRunning(Dispatcher *d, const Event *event, Slot p) {
+    int cpu = d->pcbs.info[p].cpu;
+    recordBurst(d, p);
+    account(d, p);
+    terminate(d, p);
+    runNext(d, cpu);
+}
+/**
+ * E for a ready or blocked process: takes it out of its queue, and puts it in the finished list
+ */
+static void exitWaiting(Dispatcher *d, const Event *event, Slot p) {
+    fprintf(d->log, "Notice: terminating process %d from a non-running state\n", event->pid);
+    stopWaiting(d, p);
+    terminate(d, p);
+}
+/**
+ * E with no such process: ignored
+ */
+static void exitMissing(Dispatcher *d, const Event *event, Slot p) {
+    fprintf(d->log, "Notice: terminating process %d from a non-running state\n", event->pid);
+    fprintf(d->log, "Error: process ID %d does not exist --ignoring input line\n", event->pid);
+}
+
+/**
+ * R for a running process: blocks it on the resource, then runs whatever the policy picks
+ * next on its CPU, if anything
+ */
+static void blockRunning(Dispatcher *d, const Event *event, Slot p) {
+    int cpu = d->pcbs.info[p].cpu;
+    recordBurst(d, p);
+    account(d, p);
+    noteBlocked(readyQueueOf(d, cpu), p);
+    block(d, p, event->resourceNum);
+    runNext(d, cpu);
+}
+/**
+ * R for a ready process: takes it out of its ready queue, and blocks it on the resource
+ */
+static void blockReady(Dispatcher *d, const Event *event, Slot p) {
+    fprintf(d->log, "Notice: blocking process %d from a non-running state\n", event->pid);
+    stopWaiting(d, p);
+    noteBlocked(readyQueueOf(d, d->pcbs.info[p].cpu), p);
+    block(d, p, event->resourceNum);
+}
+/**
+ * R for a blocked process: moves it from the resource queue it's in to the resource's
+ */
+static void blockBlocked(Dispatcher *d, const Event *event, Slot p) {
+    fprintf(d->log, "Notice: blocking process %d from a non-running state\n", event->pid);
+    stopWaiting(d, p);
+    block(d, p, event->resourceNum);
+}
+/**
+ * R with no such process: ignored
+ */
+static void blockMissing(Dispatcher *d, const Event *event, Slot p) {
+    fprintf(d->log, "Notice: blocking process %d from a non-running state\n", event->pid);
+    fprintf(d->log, "Error: process ID %d does not exist --ignoring input line\n", event->pid);
+}
+
+/**
+ * I for a process that isn't blocked on the resource: ignored
+ */
+static void unblockMissing(Dispatcher *d, const Event *event, Slot p) {
+    fprintf(d->log, "Error: process ID %d does not exist in resource %d's queue --ignoring input line\n",
+            event->pid, event->resourceNum);
+}
+/**
+ * I for a blocked process: if it's blocked on the resource, takes it out of the resource's
+ * queue, then runs it or adds it to a ready queue
+ */
+static void unblock(Dispatcher *d, const Event *event, Slot p) {
+    PCBTable *t = &d->pcbs;
+    if(t->info[p].owner != &d->resources[event->resourceNum]) {
+        unblockMissing(d, event, p);
+        return;
+    }
+    stopWaiting(d, p);
+    t->info[p].resource = 0;
+    admit(d, p);
+}
+
+/**
+ * T (for any process): lets each ready queue's policy know once, then interrupts every
+ * CPU, in CPU order
+ */
+static void tick(Dispatcher *d, const Event *event, Slot p) {
+    int numQueues = d->balance == GLOBAL_BALANCE ? 1 : d->numCPUs;
+    for(int i = 0; i < numQueues; i++) {
+        noteInterrupt(&d->policies[i]);
+    }
+    for(int i = 0; i < d->numCPUs; i++) {
+        Slot running = d->cpus[i].running;
+        // check if a process is running first
+        if(running == NO_SLOT) {
+            chargeIdle(d, i);
+            if(d->balance == STEAL_BALANCE) {
+                runNext(d, i);
+            }
+            continue;
+        }
+
+        // update total run time first, then let the policy decide if it's preempted (e.g.
+        // round robin does if anything is ready)
+        account(d, running);
+        Policy *ready = readyQueueOf(d, i);
+        if(!preemptOnTick(ready, running)) {
+            continue;
+        }
+
+        // put the running process in the ready queue, then run whatever the policy picks next
+        recordBurst(d, running);
+        setStatus(d, running, READY);
+        enqueueReady(ready, running);
+        runNext(d, i);
+    }
+    if(d->balance == PUSH_BALANCE) {
+        rebalance(d);
+    }
+}
+
+/**
+ * Any other event: ignored
+ */
+static void invalidEvent(Dispatcher *d, const Event *event, Slot p) {
+    fprintf(d->log, "Error: invalid event --ignoring input line\n");
+}
+
+/**
+ * What each event does, by the state of its process (NEW for no such process, which is
+ * the only row T ever needs) and the kind of event
+ */
+static const EventHandler transitions[BLOCKED + 1][NUM_EVENT_KINDS] = {
+    //             C               E            R             I               T     other
+    [NEW]     = { create,         exitMissing, blockMissing, unblockMissing, tick, invalidEvent },
+    [RUNNING] = { createExisting, exitRunning, blockRunning, unblockMissing, tick, invalidEvent },
+    [READY]   = { createExisting, exitWaiting, blockReady,   unblockMissing, tick, invalidEvent },
+    [BLOCKED] = { createExisting, exitWaiting, blockBlocked, unblock,        tick, invalidEvent },
+};
+
+// =============================== EVENT FUNCTIONS ================================
+
+/**
+ * Helper that gets the kind of an event (its column in the transition table)
+ * @param char type -the event's letter
+ * @return its kind (INVALID_EVENT if it isn't one)
+ */
+static EventKind eventKind(char type) {
+    switch(type) {
+        case 'C': return CREATE_EVENT;
+        case 'E': return EXIT_EVENT;
+        case 'R': return REQUEST_EVENT;
+        case 'I': return INTERRUPT_EVENT;
+        case 'T': return TIMER_EVENT;
+        default: return INVALID_EVENT;
+    }
+}
+
+/**
+ * Helper that checks an event's fields are in range, displaying an error if they aren't
+ * --> its time can't go backwards (or be negative), a resource number is 1-numResources,
+ *     and a process ID is non-negative (whether the process exists is up to its transition)
+ * @param Dispatcher *d -the dispatcher (its times already updated for the event)
+ * @param EventKind kind -the event's kind
+ * @param const Event *event -the event
+ * @return 1 if it's valid (or of no valid kind, which its transition reports), otherwise 0
+ */
+static int validEvent(Dispatcher *d, EventKind kind, const Event *event) {
+    if(kind == INVALID_EVENT) {
+        return 1;
+    }
+    if(d->currTime < d->prevTime || d->currTime < 0) {
+        fprintf(d->log, "Error: local time stamp must be a strictly-increasing, non-negative integer - input line will be ignored\n");
+        return 0;
+    }
+    if((kind == REQUEST_EVENT || kind == INTERRUPT_EVENT) && (event->resourceNum < 1 || event->resourceNum > d->numResources)) {
+        fprintf(d->log, "Error: resource number must be an integer [1,%d] - input line will be ignored\n", d->numResources);
+        return 0;
+    }
+    if(kind != TIMER_EVENT && event->pid < 0) {
+        fprintf(d->log, "Error: process ID must be a non-negative integer - input line will be ignored\n");
+        return 0;
+    }
+    return 1;
+}
+
+/**
+ * Updates the dispatcher's state for an event (displaying an error, and otherwise
+ * ignoring it, if it's invalid)
+ * --> every event is checked (see validEvent), then does whatever the transition table
+ *     says for its kind and its process's state; with strict off, the check is skipped,
+ *     and an event that would have failed it gives undefined results
+ * @param Dispatcher *d -the dispatcher
+ * @param Event *event -the event
+ */
+void processEvent(Dispatcher *d, Event *event) {
+    // print a snapshot first if this event is past the next multiple of the interval
+    if(d->snapshotInterval > 0 && event->time >= d->nextSnapshot) {
+        long long boundary = event->time - event->time % d->snapshotInterval;
+        printSnapshot(d, boundary, d->out);
+        d->nextSnapshot = boundary + d->snapshotInterval;
+    }
+
+    d->prevTime = d->currTime; // keep track of this to calculate difference
+    d->currTime = event->time;
+    EventKind kind = eventKind(event->type);
+    STAT_ADD(STAT_C_EVENTS + kind, 1);
+    if(d->strict) {
+        STAT_START(start);
+        int valid = validEvent(d, kind, event);
+        STAT_STOP(VALIDATE_PHASE, start);
+        if(!valid) {
+            return;
+        }
+    }
+    STAT_START(start);
+    Slot p = event->pid < 0 ? NO_SLOT : indexFind(&d->index, event->pid);
+    transitions[p == NO_SLOT ? NEW : d->pcbs.status[p]][kind](d, event, p);
+    STAT_STOP(TRANSITION_PHASE, start);
+}
+
+/**
+ * Helper that checks if a timer interrupt right now would only move time forward
+ * --> true when nothing is ready anywhere (so nothing is preempted, stolen or pushed) and
+ *     the policy's tick doesn't change anything when nothing is ready (round robin and
+ *     priority - mlfq counts ticks and quanta, stride charges passes, srt re-predicts)
+ * @param Dispatcher *d -the dispatcher
+ * @return 1 if a timer interrupt can only add to run and idle times, otherwise 0
+ */
+static int ticksOnlyAccount(Dispatcher *d) {
+    PolicyKind kind = d->policies[0].kind;
+    if(kind != FIFO_POLICY && kind != PRIORITY_POLICY) {
+        return 0;
+    }
+    int numQueues = d->balance == GLOBAL_BALANCE ? 1 : d->numCPUs;
+    for(int i = 0; i < numQueues; i++) {
+        if(d->policies[i].count != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Helper that applies a run of timer interrupts that only move time forward, all at once
+ * --> every CPU is charged from its last update up to the last interrupt's time in one
+ *     step, which is what each interrupt in turn would have added up to (an idle CPU
+ *     from the event before the run if it's the only one, see chargeIdle)
+ * @param Dispatcher *d -the dispatcher
+ * @param long long prevTime -the time of the second last interrupt in the run (or of the
+ *          event before the run, if it's only one interrupt)
+ * @param long long currTime -the time of the last interrupt in the run
+ */
+static void applyTicks(Dispatcher *d, long long prevTime, long long currTime) {
+    STAT_START(start);
+    PCBTable *t = &d->pcbs;
+    for(int i = 0; i < d->numCPUs; i++) {
+        Slot running = d->cpus[i].running;
+        if(running == NO_SLOT) {
+            d->cpus[i].idleTime += currTime - (d->numCPUs == 1 ? d->currTime : d->cpus[i].idleSince);
+            d->cpus[i].idleSince = currTime;
+        } else {
+            t->runTime[running] += currTime - t->prevTime[running];
+            t->prevTime[running] = currTime;
+        }
+    }
+    d->prevTime = prevTime;
+    d->currTime = currTime;
+    STAT_STOP(ACCOUNT_PHASE, start);
+}
+
+/**
+ * Updates the dispatcher's state for a batch of events, in order (just like processEvent
+ * for each of them)
+ * --> runs of timer interrupts that only move time forward are applied in one step (see
+ *     applyTicks); an invalid time or a snapshot to print ends a run, and that interrupt
+ *     is processed on its own
+ * @param Dispatcher *d -the dispatcher
+ * @param Event *events -the events
+ * @param int count -how many events there are
+ */
+void processEvents(Dispatcher *d, Event *events, int count) {
+    for(int i = 0; i < count; i++) {
+        if(events[i].type != 'T' || !ticksOnlyAccount(d)) {
+            processEvent(d, &events[i]);
+            continue;
+        }
+        // find how far the run of valid interrupts goes (before any snapshot is due)
+        long long prevTime = d->currTime;
+        int end = i;
+        while(end < count && events[end].type == 'T' && events[end].time >= prevTime && events[end].time >= 0
+                && (d->snapshotInterval == 0 || events[end].time < d->nextSnapshot)) {
+            prevTime = events[end].time;
+            end++;
+        }
+        if(end == i) {
+            processEvent(d, &events[i]);
+            continue;
+        }
+        STAT_ADD(STAT_T_EVENTS, end - i);
+        STAT_ADD(STAT_BATCHED_TICKS, end - i);
+        applyTicks(d, end - i == 1 ? d->currTime : events[end - 2].time, events[end - 1].time);
+        i = end - 1;
+    }
+}
+
+// ============================ DISPATCHER FUNCTIONS ==============================
+
+/**
+ * Gets the balancing strategy with the given name
+ * @param const char *name -the name (global, push or steal)
+ * @param BalanceKind *kind -will hold the balancing strategy
+ * @return 1 if it's the name of a balancing strategy, otherwise 0
+ */
+int parseBalanceKind(const char *name, BalanceKind *kind) {
+    const char *names[] = { "global", "push", "steal" };
+    for(int i = 0; i < 3; i++) {
+        if(strcmp(name, names[i]) == 0) {
+            *kind = (BalanceKind)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Gets the default setup: one CPU, round robin, 5 resources
+ * @param DispatcherConfig *config -will hold the default setup
+ */
+void defaultConfig(DispatcherConfig *config) {
+    config->policy = FIFO_POLICY;
+    config->numCPUs = 1;
+    config->balance = GLOBAL_BALANCE;
+    config->numResources = 5;
+    config->stream = 0;
+    config->snapshotInterval = 0;
+    config->latency = 0;
+    config->strict = 1;
+    config->sample = 0;
+}
+
+/**
+ * Initializes a dispatcher with no processes, all its CPUs idle
+ * @param Dispatcher *d -the dispatcher being initialized
+ * @param const DispatcherConfig *config -how it's set up
+ */
+void initDispatcher(Dispatcher *d, const DispatcherConfig *config) {
+    int numCPUs = config->numCPUs;
+    d->out = stdout;
+    d->log = stderr;
+    d->stream = config->stream;
+    d->strict = config->strict;
+    d->snapshotInterval = config->snapshotInterval;
+    d->nextSnapshot = config->snapshotInterval;
+    d->numFinished = 0;
+    d->latency = NULL;
+    d->sample = NULL;
+    d->trace = NULL;
+    if(config->latency) {
+        d->latency = malloc(sizeof(Latency));
+        initHistogram(&d->latency->wait);
+        initHistogram(&d->latency->burst);
+        initHistogram(&d->latency->blocked);
+        d->latency->resources = malloc((config->numResources + 1) * sizeof(Histogram));
+        for(int i = 0; i <= config->numResources; i++) {
+            initHistogram(&d->latency->resources[i]);
+        }
+    }
+    if(config->sample > 0) {
+        d->sample = malloc(sizeof(Sample));
+        d->sample->size = config->sample;
+        d->sample->random = 0x9E3779B97F4A7C15ULL;
+        d->sample->runTotal = d->sample->readyTotal = d->sample->blockTotal = 0;
+        initHistogram(&d->sample->run);
+        initHistogram(&d->sample->ready);
+        initHistogram(&d->sample->blocked);
+    }
+    d->numCPUs = numCPUs;
+    d->balance = config->balance;
+    d->nextCPU = numCPUs - 1;
+    initTable(&d->pcbs);
+    d->cpus = malloc(numCPUs * sizeof(CPU));
+    d->policies = malloc(numCPUs * sizeof(Policy));
+    for(int i = 0; i < numCPUs; i++) {
+        d->cpus[i].running = NO_SLOT;
+        d->cpus[i].idleTime = d->cpus[i].idleSince = 0;
+        initPolicy(&d->policies[i], config->policy, &d->pcbs);
+    }
+    d->numResources = config->numResources;
+    d->resources = malloc((d->numResources + 1) * sizeof(Queue));
+    for(int i = 0; i <= d->numResources; i++) {
+        initQueue(&d->resources[i]);
+    }
+    initList(&d->finished);
+    initIndex(&d->index);
+    d->prevTime = d->currTime = 0;
+}
+/**
+ * Deletes (Frees) a dispatcher and every process it still has
+ * @param Dispatcher *d -the dispatcher to be deleted
+ */
+void deleteDispatcher(Dispatcher *d) {
+    for(int i = 0; i < d->numCPUs; i++) {
+        deletePolicy(&d->policies[i]);
+        deletePCB(&d->pcbs, d->cpus[i].running);
+    }
+    for(int i = 1; i <= d->numResources; i++) {
+        deleteQueue(&d->pcbs, &d->resources[i]);
+    }
+    deleteList(&d->pcbs, &d->finished);
+    deleteIndex(&d->index);
+    deleteTable(&d->pcbs);
+    free(d->cpus);
+    free(d->policies);
+    free(d->resources);
+    if(d->latency != NULL) {
+        free(d->latency->resources);
+        free(d->latency);
+        d->latency = NULL;
+    }
+    free(d->sample);
+    d->sample = NULL;
+    d->cpus = NULL;
+    d->policies = NULL;
+    d->resources = NULL;
+    d->numCPUs = 0;
+}
+
+/**
+ * Prints a snapshot of the dispatcher's state on one line
+ *  --> Format: snapshot time=<t> idle=<cpu 0>[,<cpu 1>...] running=<n> ready=<n> blocked=<n> finished=<n>
+ * @param Dispatcher *d -the dispatcher
+ * @param long long time -the time the snapshot is for
+ * @param FILE *out -where to print it
+ */
+void printSnapshot(Dispatcher *d, long long time, FILE *out) {
+    int running = 0, ready = 0, blocked = 0;
+    fprintf(out, "snapshot time=%lld idle=", time);
+    for(int i = 0; i < d->numCPUs; i++) {
+        fprintf(out, i == 0 ? "%lld" : ",%lld", d->cpus[i].idleTime);
+        running += (d->cpus[i].running != NO_SLOT);
+        ready += d->policies[i].count;
+    }
+    for(int i = 1; i <= d->numResources; i++) {
+        blocked += d->resources[i].length;
+    }
+    fprintf(out, " running=%d ready=%d blocked=%d finished=%ld\n", running, ready, blocked, d->numFinished);
+}
+/**
+ * Prints the results once the input has ended: each CPU's idle time, then all completed
+ * processes' times (by ID) - when streaming, those were already printed as each one exited
+ *  --> Format: 0 <idle time of CPU 0> [<idle time of CPU 1> ...]
+ *              <process id> <total time Running> <total time Ready> <total time Blocked>
+ *  --> with a sample size, only the sampled processes' times are printed, followed by the
+ *      totals over every finished process and their distributions:
+ *              sample finished=<n> kept=<n> run=<total> ready=<total> blocked=<total>
+ *              sample run|ready|blocked count=<n> p50=<t> ... (see printHistogram)
+ *  --> followed by the latency percentiles if they were recorded (see printHistogram)
+ * @param Dispatcher *d -the dispatcher
+ * @param FILE *out -where to print them
+ */
+void printResults(Dispatcher *d, FILE *out) {
+    // nothing should still be ready, blocked or running
+    for(int i = 0; i < d->numCPUs; i++) {
+        if(d->policies[i].count != 0) {
+            fprintf(d->log, "Error: ready queue should be empty, but isn't\n");
+        }
+        if(d->cpus[i].running != NO_SLOT) {
+            fprintf(d->log, "Error: there shouldn't be a running process, but there is\n");
+        }
+    }
+    for(int i = 1; i <= d->numResources; i++) {
+        if(d->resources[i].length != 0) {
+            fprintf(d->log, "Error: queue %d should be empty, but isn't\n", i);
+        }
+    }
+
+    sortByID(&d->pcbs, &d->finished);
+    fprintf(out, "0");
+    for(int i = 0; i < d->numCPUs; i++) {
+        fprintf(out, " %lld", d->cpus[i].idleTime);
+    }
+    fprintf(out, "\n");
+    printList(&d->pcbs, &d->finished, out);
+
+    // then, if only a sample was kept, what every finished process added up to
+    if(d->sample != NULL) {
+        fprintf(out, "sample finished=%ld kept=%d run=%lld ready=%lld blocked=%lld\n", d->numFinished,
+                d->finished.count, d->sample->runTotal, d->sample->readyTotal, d->sample->blockTotal);
+        printHistogram(&d->sample->run, "sample run", out);
+        printHistogram(&d->sample->ready, "sample ready", out);
+        printHistogram(&d->sample->blocked, "sample blocked", out);
+    }
+
+    // then the latency percentiles, overall and for each resource that was used
+    if(d->latency != NULL) {
+        printHistogram(&d->latency->wait, "latency wait", out);
+        printHistogram(&d->latency->burst, "latency burst", out);
+        printHistogram(&d->latency->blocked, "latency blocked", out);
+        for(int i = 1; i <= d->numResources; i++) {
+            if(d->latency->resources[i].total > 0) {
+                char name[48];
+                snprintf(name, sizeof(name), "latency blocked resource=%d", i);
+                printHistogram(&d->latency->resources[i], name, out);
+            }
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> The dispatcher's state, and how each event changes it
+ */
+
+#ifndef DISPATCHER_H
+#define DISPATCHER_H
+
+#include <stdio.h>
+
+#include "pcb.h"
+#include "events.h"
+#include "policy.h"
+#include "histogram.h"
+#include "tracesink.h"
+
+#define MAX_CPUS 1024           // most CPUs a dispatcher can have
+#define MAX_RESOURCES 65536     // most resources a dispatcher can have
+
+// =================================== STRUCTS ====================================
+
+/**
+ * How ready processes are spread over the CPUs when there's more than one
+ *  --> global: one ready queue shared by every CPU
+ *  --> push: per-CPU ready queues, new/unblocked processes go to the least loaded CPU,
+ *      and every timer interrupt pushes processes from the busiest to the least loaded
+ *  --> steal: per-CPU ready queues, processes go back to the CPU they last ran on, and a
+ *      CPU with nothing left to run takes a process from the busiest one
+ */
+typedef enum balance_kind { GLOBAL_BALANCE, PUSH_BALANCE, STEAL_BALANCE } BalanceKind;
+
+/**
+ * How a dispatcher is set up
+ */
+typedef struct dispatcher_config_struct {
+    PolicyKind policy;          // the scheduling policy every ready queue uses
+    int numCPUs;                // how many CPUs there are (1 to MAX_CPUS)
+    BalanceKind balance;        // how ready processes are spread over the CPUs
+    int numResources;           // how many resources there are, numbered from 1 (1 to MAX_RESOURCES)
+    int stream;                 // print each process's times as soon as it exits, then free it
+    long long snapshotInterval; // simulated time between state snapshots (0 for none)
+    int latency;                // record latency histograms (reported with the results)
+    int strict;                 // check each event is valid before applying it (0 trusts the input)
+    long long sample;           // keep only a random sample of this many finished processes (0 for all)
+} DispatcherConfig;
+
+/**
+ * Latency distributions (each interval is recorded as it ends)
+ *  --> wait: from becoming ready (or being created/unblocked) until running
+ *  --> burst: each continuous stretch on a CPU, until preempted, blocked or exiting
+ *  --> blocked: each time blocked on a resource, overall and per resource
+ */
+typedef struct latency_struct {
+    Histogram wait, burst, blocked;
+    Histogram *resources;       // indexed by resource number (1-numResources)
+} Latency;
+
+/**
+ * Approximate results: only a reservoir sample of the finished processes is kept (in the
+ * finished list, replaced at random so each one is equally likely to be there), but every
+ * one of them still counts towards the totals and the distributions
+ */
+typedef struct sample_struct {
+    long long size;                 // the most finished processes kept
+    unsigned long long random;      // the sampler's random state (fixed seed, so runs repeat)
+    long long runTotal, readyTotal, blockTotal;     // over every finished process
+    Histogram run, ready, blocked;  // of each finished process's total times
+} Sample;
+
+/**
+ * One simulated CPU
+ */
+typedef struct cpu_struct {
+    Slot running;       // the running process (NO_SLOT if it's running the system idle process)
+    long long idleTime; // time spent idle (up to idleSince)
+    long long idleSince;// when it was last charged for idle time, or went idle
+} CPU;
+
+/**
+ * Everything the dispatcher keeps track of
+ */
+typedef struct dispatcher_struct {
+    FILE *out;                  // where streamed times and snapshots go (stdout by default)
+    FILE *log;                  // where errors and notices about the input go (stderr by default)
+    int stream;
+    int strict;
+    long long snapshotInterval, nextSnapshot;
+    int numCPUs;
+    CPU *cpus;
+    BalanceKind balance;
+    Policy *policies;           // the ready queue(s): one per CPU, or one shared (global)
+    int nextCPU;                // where the next new process goes (steal)
+    int numResources;
+    Queue *resources;           // one queue per resource, indexed by resource number (1-numResources)
+    Latency *latency;           // NULL unless latency is recorded
+    Sample *sample;             // NULL unless only a sample of the finished processes is kept
+    TraceSink *trace;           // where state transitions go (NULL unless they're traced)
+    long numFinished;           // how many processes have terminated
+    PCBList finished;           // terminated processes (or a sample of them), sorted by ID only once input ends (unless streaming)
+    PIDIndex index;             // finds any live (non-terminated) process by its ID
+    PCBTable pcbs;              // every PCB is allocated from (and freed back to) here
+    long long prevTime, currTime;   // times of the previous and current events
+} Dispatcher;
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+int parseBalanceKind(const char *name, BalanceKind *kind);
+void defaultConfig(DispatcherConfig *config);
+void initDispatcher(Dispatcher *d, const DispatcherConfig *config);
+void deleteDispatcher(Dispatcher *d);
+
+void processEvent(Dispatcher *d, Event *event);
+void processEvents(Dispatcher *d, Event *events, int count);
+void printSnapshot(Dispatcher *d, long long time, FILE *out);
+void printResults(Dispatcher *d, FILE *out);
+
+#endif
@@ -0,0 +1,615 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Reads simulated events from the input, one event per line
+ *         <time> <event> [<resource number>] [<process id>] [<priority>]
+ * --> Only 'C' has the (optional) priority, 0 if it's not given
+ * --> An empty (or all whitespace) line, or the end of the input, ends the events
+ * --> Binary traces (see events.h) hold the same events as fixed-width records instead
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "events.h"
+#include "stats.h"
+
+#define READ_CHUNK (1 << 20)    // bytes read at a time when the input can't be mapped
+
+// ================================ READER FUNCTIONS ==============================
+
+/**
+ * Opens a reader on an input file (memory-mapped if it's a regular file)
+ * @param EventReader *reader -the reader being opened
+ * @param const char *path -the file to read, or NULL or "-" for stdin
+ * @param InputFormat format -whether the input is text lines or a binary trace
+ * @return 1 if it was opened, 0 if the file couldn't be opened
+ */
+int openReader(EventReader *reader, const char *path, InputFormat format) {
+    if(path == NULL || strcmp(path, "-") == 0) {
+        openReaderFd(reader, STDIN_FILENO, format);
+        return 1;
+    }
+    int fd = open(path, O_RDONLY);
+    if(fd < 0) {
+        return 0;
+    }
+
+    // map regular files whole, everything else gets read through a buffer
+    struct stat st;
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data != MAP_FAILED) {
+            posix_madvise(data, st.st_size, POSIX_MADV_SEQUENTIAL);
+            close(fd);
+            reader->fd = -1;
+            reader->data = data;
+            reader->size = reader->capacity = st.st_size;
+            reader->pos = 0;
+            reader->base = 0;
+            reader->mapped = 1;
+            reader->ownsFd = 0;
+            reader->atEOF = 1;
+            reader->format = format;
+            reader->version = 0;
+            reader->log = stderr;
+            return 1;
+        }
+    }
+    openReaderFd(reader, fd, format);
+    reader->ownsFd = 1;
+    return 1;
+}
+/**
+ * Opens a reader that reads an already open file descriptor in large chunks
+ * @param EventReader *reader -the reader being opened
+ * @param int fd -the file descriptor to read (it's not closed by closeReader)
+ * @param InputFormat format -whether the input is text lines or a binary trace
+ */
+void openReaderFd(EventReader *reader, int fd, InputFormat format) {
+    reader->fd = fd;
+    reader->capacity = READ_CHUNK;
+    reader->data = malloc(reader->capacity);
+    reader->size = reader->pos = 0;
+    reader->base = 0;
+    reader->mapped = reader->ownsFd = reader->atEOF = 0;
+    reader->format = format;
+    reader->version = 0;
+    reader->log = stderr;
+}
+/**
+ * Opens a reader on input that's already in memory (a copy of it, so it can go afterwards)
+ * @param EventReader *reader -the reader being opened
+ * @param const char *data -the input
+ * @param size_t size -its length, in bytes
+ * @param InputFormat format -whether the input is text lines or a binary trace
+ */
+void openReaderBuffer(EventReader *reader, const char *data, size_t size, InputFormat format) {
+    reader->fd = -1;
+    reader->capacity = size > 0 ? size : 1;
+    reader->data = malloc(reader->capacity);
+    memcpy(reader->data, data, size);
+    reader->size = size;
+    reader->pos = 0;
+    reader->base = 0;
+    reader->mapped = reader->ownsFd = 0;
+    reader->atEOF = 1;
+    reader->format = format;
+    reader->version = 0;
+    reader->log = stderr;
+}
+/**
+ * Closes a reader, unmapping or freeing its data
+ * @param EventReader *reader -the reader being closed
+ */
+void closeReader(EventReader *reader) {
+    if(reader->mapped) {
+        munmap(reader->data, reader->size);
+    } else {
+        free(reader->data);
+    }
+    if(reader->ownsFd) {
+        close(reader->fd);
+    }
+    reader->data = NULL;
+    reader->size = reader->capacity = reader->pos = 0;
+    reader->base = 0;
+    reader->mapped = reader->ownsFd = 0;
+    reader->atEOF = 1;
+}
+
+/**
+ * Reads more of the input into the buffer, after the unread part of it (one read at most)
+ * --> the unread part is moved to the front first, and the buffer grows if that's all of it
+ * @param EventReader *reader -the reader being refilled
+ * @return 1 if more was read, 0 if the input has ended, or -1 if the reader's file
+ *          descriptor is non-blocking and nothing is available yet
+ */
+int fillReader(EventReader *reader) {
+    if(reader->mapped || reader->atEOF) {
+        reader->atEOF = 1;
+        return 0;
+    }
+    memmove(reader->data, reader->data + reader->pos, reader->size - reader->pos);
+    reader->size -= reader->pos;
+    reader->base += reader->pos;
+    reader->pos = 0;
+    if(reader->size == reader->capacity) {
+        reader->capacity *= 2;
+        reader->data = realloc(reader->data, reader->capacity);
+    }
+
+    ssize_t n;
+    do {
+        n = read(reader->fd, reader->data + reader->size, reader->capacity - reader->size);
+    } while(n < 0 && errno == EINTR);
+    if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return -1;
+    } else if(n <= 0) {
+        reader->atEOF = 1;
+        return 0;
+    }
+    reader->size += n;
+    return 1;
+}
+
+/**
+ * Gets how far into the input the reader is (the start of the next line or record)
+ * @param const EventReader *reader -the reader
+ * @return the offset, in bytes from the start of the input
+ */
+long long readerOffset(const EventReader *reader) {
+    return reader->base + (long long)reader->pos;
+}
+/**
+ * Moves the reader to an offset in the input (what readerOffset gave), seeking if the
+ * input can be, otherwise reading and throwing away everything before it
+ * @param EventReader *reader -the reader (nothing read from it yet)
+ * @param long long offset -the offset, in bytes from the start of the input
+ * @return 1 if it's there, 0 if the input is shorter than that
+ */
+int seekReader(EventReader *reader, long long offset) {
+    if(reader->mapped) {
+        if(offset > (long long)reader->size) {
+            return 0;
+        }
+        reader->pos = offset;
+        return 1;
+    }
+    if(lseek(reader->fd, offset, SEEK_SET) == offset) {
+        reader->base = offset;
+        reader->size = reader->pos = 0;
+        reader->atEOF = 0;
+        return 1;
+    }
+    while(reader->base + (long long)reader->size < offset) {
+        reader->pos = reader->size;
+        if(fillReader(reader) <= 0) {
+            return 0;
+        }
+    }
+    reader->pos = offset - reader->base;
+    return 1;
+}
+
+/**
+ * Helper that gets the next event from a binary trace if all of it has been read yet,
+ * checking the trace's header first
+ * @param EventReader *reader -the reader being read from
+ * @param Event *event -will hold the event that was read
+ * @return 1 if an event was read, 0 if more input is needed first, or -1 if the trace
+ *          has ended (or its header is bad)
+ */
+static int pollRecord(EventReader *reader, Event *event) {
+    size_t needed = reader->version != 0 ? TRACE_RECORD_SIZE : TRACE_HEADER_SIZE;
+    if(reader->size - reader->pos < needed) {
+        if(!reader->atEOF) {
+            return 0;
+        }
+        if(reader->size != reader->pos) {
+            fprintf(reader->log, "Error: binary trace ends part way through a %s\n", reader->version != 0 ? "record" : "header");
+            reader->pos = reader->size;
+        }
+        return -1;
+    }
+
+    // check the header the first time through
+    if(reader->version == 0) {
+        reader->version = decodeHeader((unsigned char*)reader->data + reader->pos);
+        if(reader->version == 0) {
+            fprintf(reader->log, "Error: input is not a binary event trace (up to version %d)\n", TRACE_VERSION);
+            reader->pos = reader->size;
+            reader->atEOF = 1;
+            return -1;
+        }
+        reader->pos += TRACE_HEADER_SIZE;
+        return pollRecord(reader, event);
+    }
+
+    decodeRecord((unsigned char*)reader->data + reader->pos, reader->version, event);
+    reader->pos += TRACE_RECORD_SIZE;
+    return 1;
+}
+
+/**
+ * Gets the next event out of what has been read so far, without reading any more
+ * (see fillReader), so input can be taken as it arrives
+ * @param EventReader *reader -the reader being read from
+ * @param Event *event -will hold the event that was read
+ * @return 1 if an event was read, 0 if more input is needed first, or -1 if the input
+ *          has ended (blank line or end of input)
+ */
+int pollEvent(EventReader *reader, Event *event) {
+    if(reader->format == BINARY_FORMAT) {
+        return pollRecord(reader, event);
+    }
+    const char *line = reader->data + reader->pos;
+    const char *end = reader->data + reader->size;
+    const char *stop = decodeEvent(line, end, event);
+    // a whole line was decoded, so move past it
+    if(stop < end) {
+        reader->pos = stop + 1 - reader->data;
+        return event->type != '\0' ? 1 : -1;
+    }
+    // the last line doesn't have a '\n', so it ends with the input
+    if(reader->atEOF) {
+        reader->pos = reader->size;
+        return event->type != '\0' ? 1 : -1;
+    }
+    // otherwise the line isn't all here yet
+    return 0;
+}
+
+/**
+ * Gets the next event from the input, waiting for more of it if needed
+ * @param EventReader *reader -the reader being read from (its file descriptor blocking)
+ * @param Event *event -will hold the event that was read
+ * @return 1 if an event was read, 0 if the input has ended (blank line or end of input)
+ */
+int nextEvent(EventReader *reader, Event *event) {
+    int status;
+    while((status = pollEvent(reader, event)) == 0) {
+        fillReader(reader);
+    }
+    return status == 1;
+}
+
+/**
+ * Gets several events from the input at once, waiting for more of it if needed
+ * @param EventReader *reader -the reader being read from (its file descriptor blocking)
+ * @param Event *events -will hold the events that were read
+ * @param int max -the most events to read
+ * @return how many events were read (fewer than max only once the input has ended, which
+ *          then mustn't be read from again)
+ */
+int nextEvents(EventReader *reader, Event *events, int max) {
+    STAT_START(start);
+    int count = 0;
+    while(count < max && nextEvent(reader, &events[count])) {
+        count++;
+    }
+    STAT_STOP(PARSE_PHASE, start);
+    return count;
+}
+
+// =============================== DECODING FUNCTIONS =============================
+
+/**
+ * Helper that checks if a character separates the tokens of a line
+ * @param char c -the character being checked
+ * @return 1 if it's a space, tab or carriage return, otherwise 0
+ */
+static int isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+/**
+ * Helper that decodes the next token of a line as an integer (like atoi does, but checked)
+ * @param const char **p -where to start, will be moved past the token
+ * @param const char *end -where the input ends
+ * @param long long max -the largest magnitude allowed
+ * @param long long *value -will hold the integer (0 if the token isn't a number, or
+ *          -max/max if it's out of range)
+ * @return 1 if there was a token, 2 if there was one but it was out of range,
+ *          0 if the line ended first
+ */
+static int decodeInt(const char **p, const char *end, long long max, long long *value) {
+    const char *q = *p;
+    while(q < end && isBlank(*q)) q++;
+    if(q == end || *q == '\n') {
+        *p = q;
+        return 0;
+    }
+
+    int negative = 0;
+    if(*q == '-' || *q == '+') {
+        negative = *q == '-';
+        q++;
+    }
+    long long n = 0;
+    int overflow = 0;
+    while(q < end && *q >= '0' && *q <= '9') {
+        int digit = *q - '0';
+        if(n > (max - digit) / 10) {
+            overflow = 1;   // keep going to skip the rest of the digits
+        } else {
+            n = n * 10 + digit;
+        }
+        q++;
+    }
+    if(overflow) {
+        n = max;
+    }
+    *value = negative ? -n : n;
+
+    // skip whatever's left of the token
+    while(q < end && *q != '\n' && !isBlank(*q)) q++;
+    *p = q;
+    return overflow ? 2 : 1;
+}
+
+/**
+ * Decodes one input line in a single pass, directly from where it's stored
+ *  --> Format: <time> <event> [<resource number>] [<process id>] [<priority>]
+ * @param const char *line -the start of the line
+ * @param const char *end -where the input ends (the line might not have a '\n')
+ * @param Event *event -will hold the event: its type is '\0' if the line is blank,
+ *          or '?' if it's missing its event, resource number or process ID
+ *          --> a time, resource number or process ID too big for its type is -1 (so it's
+ *              rejected like any other negative one), a priority is clamped instead
+ * @return where the line ends: its '\n', or end if it doesn't have one
+ */
+const char* decodeEvent(const char *line, const char *end, Event *event) {
+    const char *p = line;
+    long long value;
+    int status;
+    event->type = '\0';
+    event->resourceNum = event->pid = -1;
+    event->priority = 0;
+
+    // parse time (a blank line has no time)
+    if((status = decodeInt(&p, end, LLONG_MAX, &event->time)) != 0) {
+        if(status == 2) event->time = -1;
+        // parse event (only its first character matters)
+        while(p < end && isBlank(*p)) p++;
+        if(p < end && *p != '\n') {
+            event->type = *p;
+            while(p < end && *p != '\n' && !isBlank(*p)) p++;
+        } else {
+            event->type = '?';
+        }
+
+        // parse resource number - only if the event is 'R' or 'I'
+        if(event->type == 'R' || event->type == 'I') {
+            status = decodeInt(&p, end, INT_MAX, &value);
+            if(status == 0) event->type = '?';
+            event->resourceNum = status == 1 ? (int)value : -1;
+        }
+        // parse process ID - check if the event is 'T', in which case there isn't one
+        if(event->type != 'T' && event->type != '?') {
+            status = decodeInt(&p, end, INT_MAX, &value);
+            if(status == 0) event->type = '?';
+            event->pid = status == 1 ? (int)value : -1;
+        }
+        // parse priority - only if the event is 'C', and it's optional
+        if(event->type == 'C' && decodeInt(&p, end, INT_MAX, &value)) {
+            event->priority = (int)value;
+        }
+    }
+
+    // anything else on the line is ignored
+    while(p < end && *p != '\n') p++;
+    return p;
+}
+
+// ================================ BINARY FUNCTIONS ==============================
+
+/**
+ * Helper that stores an integer of the given size in little-endian byte order
+ * @param unsigned char *p -where to store it
+ * @param uint64_t value -the value being stored (only the low bytes are used)
+ * @param int size -how many bytes to store
+ */
+static void putLE(unsigned char *p, uint64_t value, int size) {
+    for(int i = 0; i < size; i++) {
+        p[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+/**
+ * Helper that loads an integer of the given size stored in little-endian byte order
+ * @param const unsigned char *p -where it's stored
+ * @param int size -how many bytes it is
+ * @return the value (not sign-extended)
+ */
+static uint64_t getLE(const unsigned char *p, int size) {
+    uint64_t value = 0;
+    for(int i = size - 1; i >= 0; i--) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+/**
+ * Writes the header of a binary trace
+ * @param unsigned char *header -where to write it (TRACE_HEADER_SIZE bytes)
+ */
+void encodeHeader(unsigned char *header) {
+    memcpy(header, TRACE_MAGIC, 8);
+    putLE(header + 8, TRACE_VERSION, 2);
+    putLE(header + 10, TRACE_RECORD_SIZE, 2);
+    putLE(header + 12, 0, 4);
+}
+/**
+ * Checks the header of a binary trace
+ * @param const unsigned char *header -the header (TRACE_HEADER_SIZE bytes)
+ * @return the trace's version if it's one this version can read, otherwise 0
+ */
+int decodeHeader(const unsigned char *header) {
+    int version = (int)getLE(header + 8, 2);
+    if(memcmp(header, TRACE_MAGIC, 8) != 0 || version < 1 || version > TRACE_VERSION
+            || getLE(header + 10, 2) != TRACE_RECORD_SIZE) {
+        return 0;
+    }
+    return version;
+}
+
+/**
+ * Writes an event as a binary trace record
+ * --> resource numbers (and priorities) that don't fit in 16 bits are stored as the
+ *     nearest one that does
+ * @param const Event *event -the event being written
+ * @param unsigned char *record -where to write it (TRACE_RECORD_SIZE bytes)
+ */
+void encodeRecord(const Event *event, unsigned char *record) {
+    int resourceNum = event->type == 'C' ? event->priority : event->resourceNum;
+    if(resourceNum > INT16_MAX) resourceNum = INT16_MAX;
+    if(resourceNum < INT16_MIN) resourceNum = INT16_MIN;
+    putLE(record, (uint64_t)(int64_t)event->time, 8);
+    putLE(record + 8, (uint32_t)event->pid, 4);
+    putLE(record + 12, (uint16_t)(int16_t)resourceNum, 2);
+    record[14] = (unsigned char)event->type;
+    record[15] = 0;
+}
+/**
+ * Reads a binary trace record
+ * @param const unsigned char *record -the record (TRACE_RECORD_SIZE bytes)
+ * @param int version -the trace's version
+ * @param Event *event -will hold the event
+ */
+void decodeRecord(const unsigned char *record, int version, Event *event) {
+    event->time = (int64_t)getLE(record, 8);
+    event->pid = (int32_t)(uint32_t)getLE(record + 8, 4);
+    event->resourceNum = (int16_t)(uint16_t)getLE(record + 12, 2);
+    event->type = (char)record[14];
+    event->priority = 0;
+    if(event->type == 'C') {
+        if(version >= 2) {
+            event->priority = event->resourceNum;
+        }
+        event->resourceNum = -1;
+    }
+}
+
+// =============================== TIME UNIT FUNCTIONS ============================
+
+/**
+ * Gets how long a time unit is
+ * @param const char *name -the unit (s, ms, us or ns)
+ * @return how many nanoseconds it is, or 0 if it isn't a time unit
+ */
+long long timeUnitNs(const char *name) {
+    const char *names[] = { "s", "ms", "us", "ns" };
+    const long long lengths[] = { 1000000000LL, 1000000LL, 1000LL, 1LL };
+    for(int i = 0; i < 4; i++) {
+        if(strcmp(name, names[i]) == 0) {
+            return lengths[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * Parses a (positive) length of time, checking it fits
+ * --> a plain number is already in the trace's time unit, otherwise it ends in s, ms, us
+ *     or ns and is converted to the trace's time unit (e.g. 5ms is 5000 in a us trace)
+ * @param const char *text -the length of time
+ * @param long long unitNs -how many nanoseconds one time unit of the trace is
+ * @param long long *value -will hold the length, in the trace's time unit
+ * @return 1 if it's a length of time that's a whole number of time units, otherwise 0
+ */
+int parseDuration(const char *text, long long unitNs, long long *value) {
+    char *suffix;
+    errno = 0;
+    long long n = strtoll(text, &suffix, 10);
+    if(errno == ERANGE || suffix == text || n < 1) {
+        return 0;
+    }
+    if(*suffix != '\0') {
+        long long suffixNs = timeUnitNs(suffix);
+        if(suffixNs == 0) {
+            return 0;
+        } else if(suffixNs >= unitNs) {
+            long long scale = suffixNs / unitNs;
+            if(n > LLONG_MAX / scale) {
+                return 0;
+            }
+            n *= scale;
+        } else {
+            long long scale = unitNs / suffixNs;
+            if(n % scale != 0) {
+                return 0;
+            }
+            n /= scale;
+        }
+    }
+    *value = n;
+    return 1;
+}
+
+// ============================= LINE-BASED FUNCTIONS =============================
+// --> the original fgets/strtok/atoi input path, kept as the reference for the reader above
+
+/**
+ * Helper that parses an input line (assuming there are no errors) storing in appropriate variables
+ * @param char* line -the input line being parsed
+ * @param int *prevTime -will hold the most recent time
+ * @param int *currTime -will hold the parsed time
+ * @param char *event -will hold the parsed event
+ * @param int *resourceNum -will hold the resource number if event is 'R' or 'I', otherwise -1
+ * @param int *pid -will hold the process ID (-1 if event is 'T')
+ */
+void parseInputLine(char* line, int *prevTime, int *currTime, char *event, int *resourceNum, int *pid) {
+    // declare var for parsing input lines
+    char *token;
+    
+    // parse time
+    *prevTime = *currTime; // keep track of this to calculate difference
+    token = strtok(line, " ");
+    *currTime = atoi(token);
+
+    // parse event
+    token = strtok(NULL, " ");
+    *event = token[0];
+
+    // parse resource number - only if the event is 'R' or 'I'
+    if(*event == 'R' || *event == 'I') {
+        token = strtok(NULL, " ");
+        *resourceNum = atoi(token);
+    } else {
+        *resourceNum = -1;
+    }
+
+    // parse process ID - check if the event is 'T', in which case there isn't one
+    if(*event != 'T') {
+        token = strtok(NULL, " ");
+        *pid = atoi(token);
+    } else {
+        *pid = -1;
+    }
+}
+
+// ================================== MY HELPERS ==================================
+
+/**
+ * Flushes all leftover data in the stdin stream
+ * @param char* input -the string that was just read from stdin
+ */
+void flushInput(char* input) {
+    // if the '\n' is NOT found in the word itself, flush the stream (null-terminate the input regardless)
+    if(strchr(input, '\n') == NULL) {
+        while ((getchar()) != '\n');
+        input[strlen(input)] = '\0';
+    } else {
+        input[strlen(input)-1] = '\0';
+    }
+}
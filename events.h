@@ -0,0 +1,88 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Reads simulated events from the input, one event per line
+ */
+
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ================================ BINARY FORMAT =================================
+// --> a 16 byte header, then one fixed-width 16 byte record per event (all little-endian)
+//         header: "IDSPTRCE" magic, uint16 version, uint16 record size, uint32 (reserved, 0)
+//         record: int64 time, int32 pid, int16 resource number, uint8 event, uint8 (reserved, 0)
+// --> the event is its text letter ('C', 'E', 'R', 'I', 'T'), unused fields are -1
+// --> since version 2, a 'C' record's resource number field holds its priority instead
+//     (version 1 traces are still read, with every priority 0)
+
+#define TRACE_MAGIC "IDSPTRCE"
+#define TRACE_VERSION 2
+#define TRACE_HEADER_SIZE 16
+#define TRACE_RECORD_SIZE 16
+
+#define EVENT_BATCH 1024        // how many events are read (and applied) at once
+
+typedef enum input_format { TEXT_FORMAT, BINARY_FORMAT } InputFormat;
+
+// =================================== STRUCTS ====================================
+
+/**
+ * One simulated event (one input line)
+ * --> type is 'C', 'E', 'R', 'I' or 'T' (anything else is an invalid event)
+ */
+typedef struct event_struct {
+    long long time;
+    char type;
+    int resourceNum;    // only for 'R' and 'I', otherwise -1
+    int pid;            // -1 for 'T'
+    int priority;       // optional for 'C' (lower is more important), otherwise 0
+} Event;
+
+/**
+ * Reads events from a file or stream without copying lines out of it
+ * --> regular files are memory-mapped, anything else (e.g. stdin) is read in large chunks
+ */
+typedef struct event_reader_struct {
+    int fd;
+    char *data;             // mapped file or read buffer
+    size_t size, capacity;  // bytes of data available, and the buffer's size if not mapped
+    size_t pos;             // start of the next line
+    long long base;         // how far into the input data starts (what's been read past)
+    int mapped;             // 1 if data is the mapped file
+    int ownsFd;             // 1 if the reader opened fd itself (so it closes it too)
+    int atEOF;              // 1 once there's nothing left to read into the buffer
+    InputFormat format;
+    int version;            // a binary trace's version, 0 until its header has been checked
+    FILE *log;              // where errors in the input go (stderr unless it's changed)
+} EventReader;
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+int openReader(EventReader *reader, const char *path, InputFormat format);
+void openReaderFd(EventReader *reader, int fd, InputFormat format);
+void openReaderBuffer(EventReader *reader, const char *data, size_t size, InputFormat format);
+int fillReader(EventReader *reader);
+int pollEvent(EventReader *reader, Event *event);
+int nextEvent(EventReader *reader, Event *event);
+int nextEvents(EventReader *reader, Event *events, int max);
+long long readerOffset(const EventReader *reader);
+int seekReader(EventReader *reader, long long offset);
+void closeReader(EventReader *reader);
+
+const char* decodeEvent(const char *line, const char *end, Event *event);
+void encodeHeader(unsigned char *header);
+int decodeHeader(const unsigned char *header);
+void encodeRecord(const Event *event, unsigned char *record);
+void decodeRecord(const unsigned char *record, int version, Event *event);
+
+long long timeUnitNs(const char *name);
+int parseDuration(const char *text, long long unitNs, long long *value);
+
+void parseInputLine(char* line, int *prevTime, int *currTime, char *event, int *resourceNum, int *pid);
+void flushInput(char* input);
+
+#endif
@@ -0,0 +1,410 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Differential test: replays random traces through a plain reference dispatcher (the
+ *     original one CPU round robin algorithm, with a linear search for everything) and
+ *     through the real one, and compares every terminated process's times and the idle
+ *     time, until the time budget runs out
+ *
+ * Usage: ./difftest [--seconds=N] [--seed=N] [--events=N] [--pids=N]
+ * --> defaults to 10 seconds of traces of 10000 events over pids 0-63, starting at seed 1
+ *     (each trace uses the next seed, so any of them can be made again)
+ * --> traces are mostly valid but not all: events for processes in the wrong state, times
+ *     going backwards, bad resource numbers and process IDs, and unknown events
+ * --> the real dispatcher applies each trace in random sized batches, so runs of timer
+ *     interrupts are collapsed at different points (see processEvents)
+ * --> on a mismatch, the trace is written to difftest_<seed>.in (replay it with
+ *     ./idispatcher) and the exit status is 1
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../events.h"
+#include "../dispatcher.h"
+
+#define REF_RESOURCES 5
+
+// =================================== STRUCTS ====================================
+
+/**
+ * A process in the reference dispatcher
+ * --> queue is 0 for the ready queue, 1-5 for a resource's, -1 if it isn't in one
+ */
+typedef struct ref_process_struct {
+    int pid;
+    ProcessState status;
+    int queue;
+    long long seq;          // when it joined its queue (queues are first in, first out)
+    long long prevTime, runTime, readyTime, blockTime;
+} RefProcess;
+
+/**
+ * The reference dispatcher
+ */
+typedef struct reference_struct {
+    RefProcess *live;       // unordered
+    int numLive, liveCapacity;
+    RefProcess *finished;   // in the order they terminated
+    int numFinished, finishedCapacity;
+    int running;            // index in live, or -1 for the system idle process
+    long long idleTime, prevTime, currTime, seq;
+} Reference;
+
+/**
+ * A process's times, as compared
+ */
+typedef struct totals_struct {
+    int pid;
+    long long runTime, readyTime, blockTime;
+} Totals;
+
+// ============================== REFERENCE DISPATCHER ============================
+
+/**
+ * Helper that finds a live process by ID
+ * @return its index in live, or -1
+ */
+static int refFind(Reference *r, int pid) {
+    for(int i = 0; i < r->numLive; i++) {
+        if(r->live[i].pid == pid) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Helper that finds the process at the front of a queue
+ * @return its index in live, or -1 if the queue is empty
+ */
+static int refFront(Reference *r, int queue) {
+    int front = -1;
+    for(int i = 0; i < r->numLive; i++) {
+        if(r->live[i].queue == queue && (front < 0 || r->live[i].seq < r->live[front].seq)) {
+            front = i;
+        }
+    }
+    return front;
+}
+
+/**
+ * Helper that puts a process at the back of a queue
+ */
+static void refEnqueue(Reference *r, int i, int queue, ProcessState status) {
+    r->live[i].queue = queue;
+    r->live[i].seq = r->seq++;
+    r->live[i].status = status;
+}
+
+/**
+ * Helper that charges a process for the time since it was last charged
+ */
+static void refCharge(Reference *r, int i) {
+    RefProcess *p = &r->live[i];
+    long long elapsed = r->currTime - p->prevTime;
+    if(p->status == RUNNING) {
+        p->runTime += elapsed;
+    } else if(p->status == READY) {
+        p->readyTime += elapsed;
+    } else {
+        p->blockTime += elapsed;
+    }
+    p->prevTime = r->currTime;
+}
+
+/**
+ * Helper that runs the front of the ready queue, if anything is ready
+ */
+static void refRunNext(Reference *r) {
+    int next = refFront(r, 0);
+    r->running = next;
+    if(next >= 0) {
+        refCharge(r, next);
+        r->live[next].queue = -1;
+        r->live[next].status = RUNNING;
+    }
+}
+
+/**
+ * Helper that has a new or unblocked process run if nothing is, or wait in the ready queue
+ */
+static void refAdmit(Reference *r, int i) {
+    if(r->running < 0) {
+        r->idleTime += r->currTime - r->prevTime;
+        r->live[i].queue = -1;
+        r->live[i].status = RUNNING;
+        r->running = i;
+    } else {
+        refEnqueue(r, i, 0, READY);
+    }
+}
+
+/**
+ * Helper that moves a live process to the finished list
+ */
+static void refTerminate(Reference *r, int i) {
+    if(r->numFinished == r->finishedCapacity) {
+        r->finishedCapacity = r->finishedCapacity == 0 ? 64 : r->finishedCapacity * 2;
+        r->finished = realloc(r->finished, r->finishedCapacity * sizeof(RefProcess));
+    }
+    r->finished[r->numFinished++] = r->live[i];
+    // fill the gap with the last live process (keeping track of it if it's running)
+    r->live[i] = r->live[--r->numLive];
+    if(r->running == r->numLive) {
+        r->running = i;
+    }
+}
+
+/**
+ * Applies one event to the reference dispatcher, just as the original dispatcher did
+ * (ignoring invalid events, including creating a process whose ID is live)
+ */
+static void refProcess(Reference *r, const Event *e) {
+    r->prevTime = r->currTime;
+    r->currTime = e->time;
+    int type = e->type;
+    if(type != 'C' && type != 'E' && type != 'R' && type != 'I' && type != 'T') {
+        return;
+    }
+    if(r->currTime < r->prevTime || r->currTime < 0
+            || ((type == 'R' || type == 'I') && (e->resourceNum < 1 || e->resourceNum > REF_RESOURCES))
+            || (type != 'T' && e->pid < 0)) {
+        return;
+    }
+    int i = type == 'T' ? -1 : refFind(r, e->pid);
+
+    if(type == 'C' && i < 0) {
+        if(r->numLive == r->liveCapacity) {
+            r->liveCapacity = r->liveCapacity == 0 ? 64 : r->liveCapacity * 2;
+            r->live = realloc(r->live, r->liveCapacity * sizeof(RefProcess));
+        }
+        RefProcess *p = &r->live[r->numLive];
+        memset(p, 0, sizeof(RefProcess));
+        p->pid = e->pid;
+        p->prevTime = r->currTime;
+        refAdmit(r, r->numLive++);
+
+    } else if((type == 'E' || type == 'R') && i >= 0) {
+        int wasRunning = i == r->running;
+        refCharge(r, i);
+        if(wasRunning) {
+            r->running = -1;
+        }
+        if(type == 'E') {
+            refTerminate(r, i);
+        } else {
+            refEnqueue(r, i, e->resourceNum, BLOCKED);
+        }
+        if(wasRunning) {
+            refRunNext(r);
+        }
+
+    } else if(type == 'I' && i >= 0 && r->live[i].queue == e->resourceNum) {
+        refCharge(r, i);
+        refAdmit(r, i);
+
+    } else if(type == 'T') {
+        if(r->running < 0) {
+            r->idleTime += r->currTime - r->prevTime;
+        } else if(refFront(r, 0) >= 0) {
+            int preempted = r->running;
+            refCharge(r, preempted);
+            refEnqueue(r, preempted, 0, READY);
+            refRunNext(r);
+        }
+    }
+}
+
+// ================================ TRACE GENERATION ==============================
+
+/**
+ * Helper that gets a random number from 0 to n-1
+ */
+static int randBelow(unsigned int *state, int n) {
+    *state = *state * 1103515245u + 12345u;
+    return (int)((*state >> 8) % (unsigned int)n);
+}
+
+/**
+ * Helper that makes up the next event of a trace, mostly about live processes (in their
+ * current state in the reference dispatcher), sometimes not valid at all
+ */
+static void nextRandomEvent(Reference *r, unsigned int *state, int numPids, Event *e) {
+    static const char types[] = "CCCCEEERRRRIIIITTTTX";
+    e->type = types[randBelow(state, (int)sizeof(types) - 1)];
+    e->time = r->currTime + randBelow(state, 4);
+    e->pid = randBelow(state, numPids);
+    e->resourceNum = 1 + randBelow(state, REF_RESOURCES);
+    e->priority = 0;
+    if(r->numLive > 0 && randBelow(state, 4) != 0) {
+        RefProcess *p = &r->live[randBelow(state, r->numLive)];
+        e->pid = p->pid;
+        if(e->type == 'I' && p->status == BLOCKED) {
+            e->resourceNum = p->queue;
+        }
+    }
+    switch(randBelow(state, 100)) {
+        case 0: e->time = r->currTime - 1 - randBelow(state, 3); break;
+        case 1: e->pid = -1; break;
+        case 2: e->resourceNum = randBelow(state, 2) == 0 ? 0 : REF_RESOURCES + 1; break;
+    }
+    if(e->type == 'T' || e->type == 'X') {
+        e->pid = -1;
+    }
+    if(e->type != 'R' && e->type != 'I') {
+        e->resourceNum = -1;
+    }
+}
+
+/**
+ * Helper that writes a trace out as text (an unknown event's letter is X)
+ */
+static void writeTrace(const char *path, const Event *events, int count) {
+    FILE *out = fopen(path, "w");
+    if(out == NULL) {
+        return;
+    }
+    for(int i = 0; i < count; i++) {
+        const Event *e = &events[i];
+        if(e->type == 'R' || e->type == 'I') {
+            fprintf(out, "%lld %c %d %d\n", e->time, e->type, e->resourceNum, e->pid);
+        } else if(e->type == 'C' || e->type == 'E') {
+            fprintf(out, "%lld %c %d\n", e->time, e->type, e->pid);
+        } else {
+            fprintf(out, "%lld %c\n", e->time, e->type);
+        }
+    }
+    fprintf(out, "\n");
+    fclose(out);
+}
+
+// ================================================================================
+
+/**
+ * Helper that orders totals by process ID, keeping processes with the same ID in the
+ * order they terminated
+ */
+static void sortTotals(Totals *totals, int count) {
+    for(int i = 1; i < count; i++) {
+        Totals t = totals[i];
+        int j = i;
+        for(; j > 0 && totals[j - 1].pid > t.pid; j--) {
+            totals[j] = totals[j - 1];
+        }
+        totals[j] = t;
+    }
+}
+
+/**
+ * Helper that replays one trace through both dispatchers and compares them
+ * @return 1 if they agree, otherwise 0 (with what differs printed)
+ */
+static int compareRuns(Reference *r, Event *events, int count, unsigned int *state, FILE *null) {
+    DispatcherConfig config;
+    defaultConfig(&config);
+    Dispatcher d;
+    initDispatcher(&d, &config);
+    d.out = d.log = null;
+    for(int i = 0; i < count; ) {
+        int batch = 1 + randBelow(state, 64);
+        batch = batch > count - i ? count - i : batch;
+        processEvents(&d, events + i, batch);
+        i += batch;
+    }
+    sortByID(&d.pcbs, &d.finished);
+
+    int ok = d.cpus[0].idleTime == r->idleTime && d.finished.count == r->numFinished
+            && d.index.count == r->numLive;
+    if(!ok) {
+        fprintf(stderr, "idle %lld vs %lld, finished %d vs %d, live %d vs %d (dispatcher vs reference)\n",
+                d.cpus[0].idleTime, r->idleTime, d.finished.count, r->numFinished, d.index.count, r->numLive);
+    }
+    Totals *expected = malloc((r->numFinished + 1) * sizeof(Totals));
+    for(int i = 0; i < r->numFinished; i++) {
+        RefProcess *p = &r->finished[i];
+        expected[i] = (Totals){ p->pid, p->runTime, p->readyTime, p->blockTime };
+    }
+    sortTotals(expected, r->numFinished);
+    for(int i = 0; ok && i < r->numFinished; i++) {
+        Slot s = d.finished.items[i];
+        Totals got = { d.pcbs.pid[s], d.pcbs.runTime[s], d.pcbs.readyTime[s], d.pcbs.blockTime[s] };
+        if(got.pid != expected[i].pid || got.runTime != expected[i].runTime
+                || got.readyTime != expected[i].readyTime || got.blockTime != expected[i].blockTime) {
+            fprintf(stderr, "pid %d: %lld %lld %lld vs %lld %lld %lld (dispatcher vs reference)\n", got.pid,
+                    got.runTime, got.readyTime, got.blockTime, expected[i].runTime, expected[i].readyTime, expected[i].blockTime);
+            ok = 0;
+        }
+    }
+    free(expected);
+    deleteDispatcher(&d);
+    return ok;
+}
+
+/**
+ * Helper that gets the current time in seconds
+ * @return the monotonic clock's current time, in s
+ */
+static double nowSec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main( int argc, char *argv[] ) {
+    double seconds = 10;
+    unsigned int seed = 1;
+    int numEvents = 10000, numPids = 64;
+    for(int i = 1; i < argc; i++) {
+        if(strncmp(argv[i], "--seconds=", 10) == 0 && atof(argv[i] + 10) > 0) {
+            seconds = atof(argv[i] + 10);
+        } else if(strncmp(argv[i], "--seed=", 7) == 0) {
+            seed = (unsigned int)strtoul(argv[i] + 7, NULL, 10);
+        } else if(strncmp(argv[i], "--events=", 9) == 0 && atoi(argv[i] + 9) >= 1) {
+            numEvents = atoi(argv[i] + 9);
+        } else if(strncmp(argv[i], "--pids=", 7) == 0 && atoi(argv[i] + 7) >= 1) {
+            numPids = atoi(argv[i] + 7);
+        } else {
+            fprintf(stderr, "Usage: %s [--seconds=N] [--seed=N] [--events=N] [--pids=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    FILE *null = fopen("/dev/null", "w");
+    Event *events = malloc(numEvents * sizeof(Event));
+    double start = nowSec();
+    long long traces = 0;
+    for(; traces == 0 || nowSec() - start < seconds; traces++, seed++) {
+        // make up the trace, applying it to the reference as it goes
+        Reference r;
+        memset(&r, 0, sizeof(Reference));
+        r.running = -1;
+        unsigned int state = seed;
+        for(int i = 0; i < numEvents; i++) {
+            nextRandomEvent(&r, &state, numPids, &events[i]);
+            refProcess(&r, &events[i]);
+        }
+
+        int ok = compareRuns(&r, events, numEvents, &state, null);
+        free(r.live);
+        free(r.finished);
+        if(!ok) {
+            char path[64];
+            snprintf(path, sizeof(path), "difftest_%u.in", seed);
+            writeTrace(path, events, numEvents);
+            fprintf(stderr, "Mismatch on seed %u, trace written to %s\n", seed, path);
+            free(events);
+            return 1;
+        }
+    }
+    printf("%lld traces (%lld events) agreed in %.1f s, seeds up to %u\n", traces,
+           traces * numEvents, nowSec() - start, seed - 1);
+    free(events);
+    fclose(null);
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Fuzz target: replays an input held in memory (a binary trace if it starts with the
+ *     trace magic, otherwise text) under several setups that cover every policy and
+ *     balancing strategy, and aborts if the dispatcher's state stops adding up
+ *
+ * Usage: built with libFuzzer (`make fuzz-libfuzzer`, needs clang), LLVMFuzzerTestOneInput
+ *        is its entry point; otherwise (`make fuzz/fuzz_dispatcher`) it's a plain program
+ *        for AFL or for replaying crashes:
+ *            ./fuzz_dispatcher [input file...]     (stdin if none are given)
+ * --> the checks after each replay: every live process is running on exactly one CPU, in
+ *     exactly one ready queue or blocked on exactly one resource, and (unless streaming)
+ *     every terminated one is in the finished list
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../events.h"
+#include "../dispatcher.h"
+
+// ================================================================================
+
+/**
+ * Helper that gets the setups every input is replayed under
+ * @param int i -which setup (0 to 4)
+ * @param DispatcherConfig *config -will hold it
+ */
+static void fuzzConfig(int i, DispatcherConfig *config) {
+    defaultConfig(config);
+    config->policy = (PolicyKind)i;
+    config->numCPUs = i + 1;
+    config->balance = (BalanceKind)(i % 3);
+    config->stream = i == 2;
+    config->snapshotInterval = i == 3 ? 5 : 0;
+    config->latency = i == 1 || i == 4;
+}
+
+/**
+ * Helper that checks every live process is in exactly one place, aborting if not
+ * @param Dispatcher *d -the dispatcher, after the whole input has been applied
+ */
+static void checkState(Dispatcher *d) {
+    long live = 0;
+    for(int i = 0; i < d->numCPUs; i++) {
+        live += d->cpus[i].running != NO_SLOT;
+        live += d->policies[i].count;
+    }
+    for(int i = 1; i <= d->numResources; i++) {
+        live += d->resources[i].length;
+    }
+    if(live != d->index.count || (!d->stream && d->numFinished != d->finished.count)) {
+        fprintf(stderr, "fuzz_dispatcher: %ld processes are somewhere, but %d are live (%ld finished, %d listed)\n",
+                live, d->index.count, d->numFinished, d->finished.count);
+        abort();
+    }
+}
+
+/**
+ * Replays an input under every setup (libFuzzer's entry point)
+ * @param const uint8_t *data -the input
+ * @param size_t size -its length, in bytes
+ * @return 0
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    static FILE *null = NULL;
+    if(null == NULL) {
+        null = fopen("/dev/null", "w");
+    }
+    InputFormat format = size >= 8 && memcmp(data, TRACE_MAGIC, 8) == 0 ? BINARY_FORMAT : TEXT_FORMAT;
+    Event batch[EVENT_BATCH];
+    for(int i = 0; i < 5; i++) {
+        DispatcherConfig config;
+        fuzzConfig(i, &config);
+        Dispatcher d;
+        initDispatcher(&d, &config);
+        d.out = d.log = null;
+        EventReader reader;
+        openReaderBuffer(&reader, (const char*)data, size, format);
+        reader.log = null;
+        int count;
+        do {
+            count = nextEvents(&reader, batch, EVENT_BATCH);
+            processEvents(&d, batch, count);
+        } while(count == EVENT_BATCH);
+        closeReader(&reader);
+        checkState(&d);
+        printResults(&d, null);
+        deleteDispatcher(&d);
+    }
+    return 0;
+}
+
+#ifndef LIBFUZZER
+
+/**
+ * Helper that reads all of a file
+ * @param FILE *in -the file
+ * @param size_t *size -will hold its length, in bytes
+ * @return its contents (to be freed)
+ */
+static uint8_t* readAll(FILE *in, size_t *size) {
+    size_t capacity = 1 << 16;
+    uint8_t *data = malloc(capacity);
+    *size = 0;
+    size_t n;
+    while((n = fread(data + *size, 1, capacity - *size, in)) > 0) {
+        *size += n;
+        if(*size == capacity) {
+            capacity *= 2;
+            data = realloc(data, capacity);
+        }
+    }
+    return data;
+}
+
+int main( int argc, char *argv[] ) {
+    for(int i = argc > 1 ? 1 : 0; i < argc; i++) {
+        FILE *in = i == 0 ? stdin : fopen(argv[i], "rb");
+        if(in == NULL) {
+            fprintf(stderr, "Error: could not open %s\n", argv[i]);
+            return 1;
+        }
+        size_t size;
+        uint8_t *data = readAll(in, &size);
+        if(in != stdin) {
+            fclose(in);
+        }
+        LLVMFuzzerTestOneInput(data, size);
+        free(data);
+    }
+    return 0;
+}
+
+#endif
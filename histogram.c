@@ -0,0 +1,107 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Log-bucketed (HDR-style) histograms of non-negative times, for latency percentiles
+ */
+
+// =================================== INCLUDES ===================================
+#include <string.h>
+
+#include "histogram.h"
+
+// ================================== MY HELPERS ==================================
+
+/**
+ * Helper that gets the bucket a value goes in
+ * --> O(1): the bucket is found from the value's highest set bit and the bits below it
+ * @param unsigned long long value -the value (non-negative)
+ * @return its bucket
+ */
+static int bucketOf(unsigned long long value) {
+    if(value < (1ULL << HIST_SUB_BITS)) {
+        return (int)value;
+    }
+    int shift = (63 - __builtin_clzll(value)) - (HIST_SUB_BITS - 1);
+    return shift * HIST_HALF + (int)(value >> shift);
+}
+
+/**
+ * Helper that gets the largest value that goes in a bucket
+ * @param int bucket -the bucket
+ * @return the largest value that goes in it
+ */
+static long long highestIn(int bucket) {
+    if(bucket < (1 << HIST_SUB_BITS)) {
+        return bucket;
+    }
+    int shift = bucket / HIST_HALF - 1;
+    long long lowest = (long long)(bucket - shift * HIST_HALF) << shift;
+    return lowest + (1LL << shift) - 1;
+}
+
+// ============================== HISTOGRAM FUNCTIONS =============================
+
+/**
+ * Initializes an empty histogram
+ * @param Histogram *h -the histogram being initialized
+ */
+void initHistogram(Histogram *h) {
+    memset(h->counts, 0, sizeof(h->counts));
+    h->total = 0;
+    h->max = 0;
+}
+
+/**
+ * Records one value (negative values are recorded as 0)
+ * @param Histogram *h -the histogram
+ * @param long long value -the value
+ */
+void recordValue(Histogram *h, long long value) {
+    if(value < 0) {
+        value = 0;
+    }
+    h->counts[bucketOf((unsigned long long)value)]++;
+    h->total++;
+    if(value > h->max) {
+        h->max = value;
+    }
+}
+
+/**
+ * Gets the value a percentage of the recorded values are at or below
+ * @param const Histogram *h -the histogram
+ * @param double percentile -the percentage (0-100)
+ * @return the largest value in the bucket that reaches that percentage (never more than
+ *          the maximum recorded), or 0 if nothing has been recorded
+ */
+long long valueAtPercentile(const Histogram *h, double percentile) {
+    if(h->total == 0) {
+        return 0;
+    }
+    long long needed = (long long)(percentile / 100.0 * h->total + 0.5);
+    if(needed < 1) {
+        needed = 1;
+    }
+    long long seen = 0;
+    for(int i = 0; i < HIST_BUCKETS; i++) {
+        seen += h->counts[i];
+        if(seen >= needed) {
+            long long value = highestIn(i);
+            return value < h->max ? value : h->max;
+        }
+    }
+    return h->max;
+}
+
+/**
+ * Prints a histogram's count, percentiles and maximum on one line
+ *  --> Format: <name> count=<n> p50=<t> p99=<t> p999=<t> max=<t>
+ * @param const Histogram *h -the histogram
+ * @param const char *name -what's printed first on the line
+ * @param FILE *out -where to print it
+ */
+void printHistogram(const Histogram *h, const char *name, FILE *out) {
+    fprintf(out, "%s count=%lld p50=%lld p99=%lld p999=%lld max=%lld\n", name, h->total,
+            valueAtPercentile(h, 50.0), valueAtPercentile(h, 99.0), valueAtPercentile(h, 99.9), h->max);
+}
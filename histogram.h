@@ -0,0 +1,40 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Log-bucketed (HDR-style) histograms of non-negative times, for latency percentiles
+ */
+
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdio.h>
+
+// ================================== CONSTANTS ===================================
+// --> values below 2^HIST_SUB_BITS each get their own bucket, and every power of two
+//     range above that is split into 2^(HIST_SUB_BITS-1) equal buckets, so a value is
+//     off by at most 1/64 of itself (about 1.6%) and any 63-bit value fits
+
+#define HIST_SUB_BITS 7
+#define HIST_HALF (1 << (HIST_SUB_BITS - 1))
+#define HIST_BUCKETS ((64 - HIST_SUB_BITS) * HIST_HALF + (1 << HIST_SUB_BITS))
+
+// =================================== STRUCTS ====================================
+
+/**
+ * A histogram of recorded values (fixed size, so recording never allocates)
+ */
+typedef struct histogram_struct {
+    long long counts[HIST_BUCKETS];
+    long long total;        // how many values have been recorded
+    long long max;          // the largest one (exact)
+} Histogram;
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+void initHistogram(Histogram *h);
+void recordValue(Histogram *h, long long value);
+long long valueAtPercentile(const Histogram *h, double percentile);
+void printHistogram(const Histogram *h, const char *name, FILE *out);
+
+#endif
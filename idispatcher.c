@@ -4,14 +4,49 @@
  * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
  * --> Simulates a simple dispacter of an OS using simulated events to do CPU scheduling
  * 
- *  (1) The sequence of events will be given in the standard input (one event per line).
- *  --> Empty line will signify the end of the input.
+ *  (1) The sequence of events will be given in the standard input (one event per line),
+ *      or in the file given as a command line argument.
+ *  --> Usage: ./idispatcher [--input-format=text|bin] [--policy=NAME] [--cpus=N]
+ *                           [--balance=global|push|steal] [--resources=N]
+ *                           [--time-unit=s|ms|us|ns] [--stream] [--snapshot-interval=N]
+ *                           [--latency] [--trace=FILE [--trace-buffer=N]] [--pipeline]
+ *                           [--strict|--fast] [--stats[=json]] [--sample=N]
+ *                           [--checkpoint=FILE [--checkpoint-every=N]] [--resume=FILE]
+ *                           [input file]
+ *             ./idispatcher [options] --batch=LIST|DIR [--jobs=N] [--out-dir=DIR]
+ *             ./idispatcher [options] --daemon=SOCKET [input file or FIFO]
+ *             ./idispatcher --query=SOCKET "pid N"|totals|shutdown
+ *      (bin reads a binary event trace, see events.h and traceconv.c)
+ *      (the scheduling policy is round robin by default, see policy.c for the others)
+ *      (with more than one CPU, the first line has every CPU's idle time, see dispatcher.c)
+ *      (batch mode replays many trace files at once, see batch.c)
+ *      (daemon mode takes events as they arrive and answers queries meanwhile, see daemon.c)
+ *      (--checkpoint saves the state every N events, default 1000000, and --resume carries
+ *       on from a checkpoint with the same input and its saved setup, see checkpoint.c)
+ *      (--stream prints each process's times as it exits, see dispatcher.c)
+ *      (--time-unit is the unit of the input's times, ms by default: every time printed is
+ *       in the same unit, and --snapshot-interval can be given in any unit, e.g. 10ms)
+ *      (--latency adds wait/burst/blocked time percentiles to the output, see dispatcher.h)
+ *      (--trace writes every process state change to a Chrome trace-event JSON file, for
+ *       chrome://tracing or Perfetto, see tracesink.c)
+ *      (--pipeline reads the input and writes the output on their own threads while the
+ *       events are applied, with the same results, see pipeline.c)
+ *      (--fast skips checking each event is valid, for trusted traces such as tracegen's:
+ *       an invalid event then gives undefined results; --strict, the default, checks)
+ *      (--sample=N keeps the times of only a random sample of N finished processes, so
+ *       memory stays bounded on traces of any number of processes: idle time and the
+ *       totals over every process stay exact, with percentiles of each one's times)
+ *      (--stats prints counts of queue operations, allocations and events, and the time
+ *       spent parsing, validating, applying and accounting, to stderr once the run ends,
+ *       as JSON with --stats=json; only in a `make STATS=1` build, see stats.h)
+ *  --> Empty line (or the end of the input) will signify the end of the input.
  *  --> Format of one line is as follows:
  *         <time> <event> {<process id>} ; where:
- *             - <time> - is an integer number denoting local time in milliseconds measured
- *                        from 0 (time will be strictly increasing from line to line)
+ *             - <time> - is an integer number denoting local time in milliseconds (or the
+ *                        --time-unit) measured from 0, up to 2^63-1 (time will be strictly
+ *                        increasing from line to line)
  *             - <event> - is one of the following:
- *                 – C - create 
+ *                 – C - create (optionally followed by a priority after the process id)
  *                 – E - exit 
  *                 – R N - request resource number N 
  *                 – I N - interrupt from resource number N (request accomplished)
@@ -21,7 +56,8 @@
  * 
  *  (2) Your Dispatcher will have to keep track of events and changes in the state of the
  *      processes, taking into account the following additional conditions:
- *      1. There are 5 different kinds of resources in the system and requests can be
+ *      1. There are 5 different kinds of resources in the system (or as many as
+ *          --resources gives) and requests can be
  *          serviced out of order of arrival
  *      2. Time sharing - the process which is in running state is to be preempted as the
  *          result of the timer interrupt if there are other ready processes in the system
@@ -48,577 +84,253 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
-// =================================== STRUCTS ====================================
-
-typedef enum pstate { NEW, RUNNING, READY, BLOCKED, TERMINATED } ProcessState;
-
-/**
- * Simulated process control block (it will store all the necessary data)
- * --> stores: pid, prevTime, runTime, readyTime, blockTime
- */
-typedef struct linked_list_node_struct {
-    int pid, prevTime, runTime, readyTime, blockTime;
-    ProcessState status;
-    struct linked_list_node_struct *next;
-} PCB;
+#include "events.h"
+#include "dispatcher.h"
+#include "batch.h"
+#include "daemon.h"
+#include "checkpoint.h"
+#include "pipeline.h"
+#include "stats.h"
 
 // ============================== FUNCTION PROTOTYPES =============================
 
-PCB* createPCB(int currTime, int pid);
-void deletePCB(PCB **toDelete);
-void deleteQueue(PCB **queue);
-void pushBack(PCB **queue, PCB *toAdd);
-void insertSorted(PCB **queue, PCB *toAdd);
-PCB* popFront(PCB **queue);
-PCB* popID(PCB **queue, int pid);
-void printQueue(PCB **queue);
-
-void parseInputLine(char* line, int *prevTime, int *currTime, char *event, int *resourceNum, int *pid);
-
-void flushInput(char* input);
+void printUsage(char *program);
 
 // ================================================================================
 
 int main( int argc, char *argv[] ) {
-    // declare variables for process queues
-    PCB *runningProcess = NULL; // store the running process
-    int idleTime = 0;           // track time spent idle
-    PCB* queues[7];             // first is ready, other 5 are resources, then a "done" queue
-
-    // init all queues to empty
-    for(int i = 0; i < 7; i++) {
-        queues[i] = NULL;
+    // get the command line options (and the input file, if there is one)
+    char *path = NULL;
+    char *batchSource = NULL;
+    char *outDir = NULL;
+    char *daemonSocket = NULL;
+    char *querySocket = NULL;
+    char *checkpointPath = NULL;
+    char *resumePath = NULL;
+    char *tracePath = NULL;
+    long long traceBuffer = TRACE_SINK_CAPACITY;
+    int pipelined = 0;
+    int stats = 0;              // 1 for text, 2 for JSON
+    char *snapshotInterval = NULL;
+    long long checkpointEvery = 1000000;
+    long long unitNs = timeUnitNs("ms");
+    int jobs = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    InputFormat format = TEXT_FORMAT;
+    DispatcherConfig config;
+    defaultConfig(&config);
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--input-format=text") == 0) {
+            format = TEXT_FORMAT;
+        } else if(strcmp(argv[i], "--input-format=bin") == 0) {
+            format = BINARY_FORMAT;
+        } else if(strncmp(argv[i], "--policy=", 9) == 0 && parsePolicyKind(argv[i] + 9, &config.policy)) {
+            continue;
+        } else if(strncmp(argv[i], "--cpus=", 7) == 0 && atoi(argv[i] + 7) >= 1 && atoi(argv[i] + 7) <= MAX_CPUS) {
+            config.numCPUs = atoi(argv[i] + 7);
+        } else if(strncmp(argv[i], "--balance=", 10) == 0 && parseBalanceKind(argv[i] + 10, &config.balance)) {
+            continue;
+        } else if(strncmp(argv[i], "--resources=", 12) == 0 && atoi(argv[i] + 12) >= 1
+                && atoi(argv[i] + 12) <= MAX_RESOURCES) {
+            config.numResources = atoi(argv[i] + 12);
+        } else if(strcmp(argv[i], "--stream") == 0) {
+            config.stream = 1;
+        } else if(strcmp(argv[i], "--latency") == 0) {
+            config.latency = 1;
+        } else if(strncmp(argv[i], "--sample=", 9) == 0 && atoll(argv[i] + 9) >= 1) {
+            config.sample = atoll(argv[i] + 9);
+        } else if(strcmp(argv[i], "--strict") == 0) {
+            config.strict = 1;
+        } else if(strcmp(argv[i], "--fast") == 0) {
+            config.strict = 0;
+        } else if(strcmp(argv[i], "--stats") == 0 || strcmp(argv[i], "--stats=json") == 0) {
+            stats = argv[i][7] == '\0' ? 1 : 2;
+        } else if(strncmp(argv[i], "--time-unit=", 12) == 0 && timeUnitNs(argv[i] + 12) != 0) {
+            unitNs = timeUnitNs(argv[i] + 12);
+        } else if(strncmp(argv[i], "--snapshot-interval=", 20) == 0) {
+            snapshotInterval = argv[i] + 20;
+        } else if(strncmp(argv[i], "--batch=", 8) == 0 && argv[i][8] != '\0') {
+            batchSource = argv[i] + 8;
+        } else if(strncmp(argv[i], "--jobs=", 7) == 0 && atoi(argv[i] + 7) >= 1) {
+            jobs = atoi(argv[i] + 7);
+        } else if(strncmp(argv[i], "--out-dir=", 10) == 0 && argv[i][10] != '\0') {
+            outDir = argv[i] + 10;
+        } else if(strncmp(argv[i], "--checkpoint=", 13) == 0 && argv[i][13] != '\0') {
+            checkpointPath = argv[i] + 13;
+        } else if(strncmp(argv[i], "--checkpoint-every=", 19) == 0 && atoll(argv[i] + 19) >= 1) {
+            checkpointEvery = atoll(argv[i] + 19);
+        } else if(strncmp(argv[i], "--resume=", 9) == 0 && argv[i][9] != '\0') {
+            resumePath = argv[i] + 9;
+        } else if(strncmp(argv[i], "--trace=", 8) == 0 && argv[i][8] != '\0') {
+            tracePath = argv[i] + 8;
+        } else if(strncmp(argv[i], "--trace-buffer=", 15) == 0 && atoll(argv[i] + 15) >= 1) {
+            traceBuffer = atoll(argv[i] + 15);
+        } else if(strcmp(argv[i], "--pipeline") == 0) {
+            pipelined = 1;
+        } else if(strncmp(argv[i], "--daemon=", 9) == 0 && argv[i][9] != '\0') {
+            daemonSocket = argv[i] + 9;
+        } else if(strncmp(argv[i], "--query=", 8) == 0 && argv[i][8] != '\0') {
+            querySocket = argv[i] + 8;
+        } else if(strncmp(argv[i], "--", 2) == 0 || path != NULL) {
+            fprintf(stderr, "Error: unexpected argument %s\n", argv[i]);
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
     }
 
-    // declare variables
-    char line[102];  // 100 char max
-    char event = '\0';
-    int currTime = 0;
-    int prevTime = 0;
-    int resourceNum = -1;
-    int pid = 0;
-    
-    // continue getting input until a blank line is entered
-    while(1) {
-        fgets(line, 102, stdin);
-        flushInput(line);
-        // if input line is blank (an empty string), stop
-        if(line[0] == '\0') break;
-
-        // parse input (time, event (& maybe resource #), process ID (if it's not T))
-        parseInputLine(line, &prevTime, &currTime, &event, &resourceNum, &pid);
-
-        // based on command, update time and then execute functionality
-        if(event == 'C') {          // ========================== C ==========================
-            // make sure input is valid
-            if(currTime < prevTime || currTime < 0) {
-                fprintf(stderr, "Error: local time stamp must be a strictly-increasing, non-negative integer - input line will be ignored\n");
-                continue;
-            } else if(pid < 0) {
-                fprintf(stderr, "Error: process ID must be a non-negative integer - input line will be ignored\n");
-                continue;
-            }
-            
-            // create new process
-            PCB *newPCB = createPCB(currTime, pid);
-            // if a process is not running, update idle time and make it run
-            // otherwise, add it to the end of the ready queue
-            if(runningProcess == NULL) {
-                idleTime += currTime - prevTime;
-                newPCB->status = RUNNING;
-                runningProcess = newPCB;
-            } else {
-                newPCB->status = READY;
-                pushBack(&queues[0], newPCB);
-            }
-
-        } else if(event == 'E') {   // ========================== E ==========================
-            // make sure input is valid
-            if(currTime < prevTime || currTime < 0) {
-                fprintf(stderr, "Error: local time stamp must be a strictly-increasing, non-negative integer - input line will be ignored\n");
-                continue;
-            } else if(pid < 0) {
-                fprintf(stderr, "Error: process ID must be a non-negative integer - input line will be ignored\n");
-                continue;
-            }
-
-            // find the given process, update time, then remove and add to the done queue
-            if(runningProcess != NULL && runningProcess->pid == pid) {
-                // update total run time first
-                runningProcess->runTime += currTime - runningProcess->prevTime;
-                runningProcess->prevTime = currTime;
-                // stop running (set it back to system idle process 0), put in done queue
-                PCB *done = runningProcess;
-                runningProcess = NULL;
-                done->status = TERMINATED;
-                insertSorted(&queues[6], done);
-
-                // run the first element in the ready queue, if there is one
-                PCB *toRun = NULL;
-                toRun = popFront(&queues[0]);
-                if(toRun != NULL) {
-                    // update total ready time first
-                    toRun->readyTime += currTime - toRun->prevTime;
-                    toRun->prevTime = currTime;
-                    // have it run
-                    toRun->status = RUNNING;
-                    runningProcess = toRun;
-                }
-            }
-            // otherwise, search for it in the ready and resource queues
-            else {
-                fprintf(stderr, "Notice: terminating process %d from a non-running state\n", pid);
-                // search ready queue
-                PCB *done = NULL;
-                done = popID(&queues[0], pid);
-
-                if(done != NULL) {
-                    // update total ready time first
-                    done->readyTime += currTime - done->prevTime;
-                    done->prevTime = currTime;
-                    // put in done queue
-                    done->status = TERMINATED;
-                    insertSorted(&queues[6], done);
-                }
-                // wasn't in ready queue, so search each resource queue
-                else {
-                    int foundMatch = 0;
-                    for(int i = 1; i < 6; i++) {
-                        done = popID(&queues[i], pid);
-                        if(done != NULL) {
-                            // update total blocked time first
-                            done->blockTime += currTime - done->prevTime;
-                            done->prevTime = currTime;
-                            // put in done queue
-                            done->status = TERMINATED;
-                            insertSorted(&queues[6], done);
-                            foundMatch = 1;
-                            break;
-                        }
-                    }
-                    if(foundMatch) continue;
-                    // if it reaches here, pid DNE, so display error message, ignore line
-                    fprintf(stderr, "Error: process ID %d does not exist --ignoring input line\n", pid);
-                }
-            }
-
-        } else if(event == 'R') {   // ========================== R ==========================
-            // make sure input is valid
-            if(currTime < prevTime || currTime < 0) {
-                fprintf(stderr, "Error: local time stamp must be a strictly-increasing, non-negative integer - input line will be ignored\n");
-                continue;
-            } else if(resourceNum < 1 || resourceNum > 5) {
-                fprintf(stderr, "Error: resource number must be an integer [1,5] - input line will be ignored\n");
-                continue;
-            } else if(pid < 0) {
-                fprintf(stderr, "Error: process ID must be a non-negative integer - input line will be ignored\n");
-                continue;
-            }
-
-            // find the given process, update time, then remove and add to the specified resource queue
-            if(runningProcess != NULL && runningProcess->pid == pid) {
-                // update total run time first
-                runningProcess->runTime += currTime - runningProcess->prevTime;
-                runningProcess->prevTime = currTime;
-                // stop running (set back to system idle), put in specified resource queue
-                PCB *toBlock = runningProcess;
-                runningProcess = NULL;
-                toBlock->status = BLOCKED;
-                pushBack(&queues[resourceNum], toBlock);
-
-                // run the first element in the ready queue, if there is one
-                PCB *toRun = NULL;
-                toRun = popFront(&queues[0]);
-                if(toRun != NULL) {
-                    // update total ready time first
-                    toRun->readyTime += currTime - toRun->prevTime;
-                    toRun->prevTime = currTime;
-                    // have it run
-                    toRun->status = RUNNING;
-                    runningProcess = toRun;
-                }
-            }
-            // otherwise, search for it in the ready and resource queues
-            else {
-                fprintf(stderr, "Notice: blocking process %d from a non-running state\n", pid);
-                // search ready queue
-                PCB *toBlock = NULL;
-                toBlock = popID(&queues[0], pid);
-                if(toBlock != NULL) {
-                    // update total ready time first
-                    toBlock->readyTime += currTime - toBlock->prevTime;
-                    toBlock->prevTime = currTime;
-                    // put in specified resource queue
-                    toBlock->status = BLOCKED;
-                    pushBack(&queues[resourceNum], toBlock);
-                }
-                // wasn't in ready queue, so search each resource queue
-                else {
-                    int foundMatch = 0;
-                    for(int i = 1; i < 6; i++) {
-                        toBlock = popID(&queues[i], pid);
-                        if(toBlock != NULL) {
-                            // update total blocked time first
-                            toBlock->blockTime += currTime - toBlock->prevTime;
-                            toBlock->prevTime = currTime;
-                            // put in specified resource queue
-                            toBlock->status = BLOCKED;
-                            pushBack(&queues[resourceNum], toBlock);
-                            foundMatch = 1;
-                            break;
-                        }
-                    }
-                    if(foundMatch) continue;
-                    // if it reaches here, pid DNE, so display error message, ignore line
-                    fprintf(stderr, "Error: process ID %d does not exist --ignoring input line\n", pid);
-                }
-            }
-
-        } else if(event == 'I') {   // ========================== I ==========================
-            // make sure input is valid
-            if(currTime < prevTime || currTime < 0) {
-                fprintf(stderr, "Error: local time stamp must be a strictly-increasing, non-negative integer - input line will be ignored\n");
-                continue;
-            } else if(resourceNum < 1 || resourceNum > 5) {
-                fprintf(stderr, "Error: resource number must be an integer [1,5] - input line will be ignored\n");
-                continue;
-            } else if(pid < 0) {
-                fprintf(stderr, "Error: process ID must be a non-negative integer - input line will be ignored\n");
-                continue;
-            }
-
-            // remove specified process from specified resource queue, then add to ready queue
-            PCB *fromRQ = NULL;
-            fromRQ = popID(&queues[resourceNum], pid);
-            if(fromRQ != NULL) {
-                // update total blocked time first
-                fromRQ->blockTime += currTime - fromRQ->prevTime;
-                fromRQ->prevTime = currTime;
-                // if a process is not running, update idle time and make it run
-                if(runningProcess == NULL) {
-                    idleTime += currTime - prevTime;
-                    fromRQ->status = RUNNING;
-                    runningProcess = fromRQ;
-                }
-                // otherwise, add it to the end of the ready queue
-                else {
-                    fromRQ->status = READY;
-                    pushBack(&queues[0], fromRQ);
-                }
-            } else {
-                fprintf(stderr, "Error: process ID %d does not exist in resource %d's queue --ignoring input line\n", pid, resourceNum);
-            }
-
-        } else if(event == 'T') {   // ========================== T ==========================
-            // make sure input is valid
-            if(currTime < prevTime || currTime < 0) {
-                fprintf(stderr, "Error: local time stamp must be a strictly-increasing, non-negative integer - input line will be ignored\n");
-                continue;
-            }
-
-            // check if a process is running first
-            if(runningProcess == NULL) {
-                idleTime += currTime - prevTime;
-                continue;
-            } else if(queues[0] == NULL) {
-                continue;
-            }
-
-            // update total run time first
-            runningProcess->runTime += currTime - runningProcess->prevTime;
-            runningProcess->prevTime = currTime;
-            // put the running process in the ready queue
-            PCB *ready = runningProcess;
-            runningProcess = NULL;      //set it to system idle process 0 temporarily
-            ready->status = READY;
-            pushBack(&queues[0], ready);
-
-            // run the first element in the ready queue (already checked it wasn't empty earlier)
-            PCB *toRun = NULL;
-            toRun = popFront(&queues[0]);
-            if(toRun != NULL) {
-                // update total ready time first
-                toRun->readyTime += currTime - toRun->prevTime;
-                toRun->prevTime = currTime;
-                // have it run
-                toRun->status = RUNNING;
-                runningProcess = toRun;
-            }
-            
-        } else {                    // ========================= ELSE ========================
-            // display error message, and ignore line
-            fprintf(stderr, "Error: invalid event --ignoring input line\n");
-        } // end if statement
-    } // end while loop
+    if(snapshotInterval != NULL && !parseDuration(snapshotInterval, unitNs, &config.snapshotInterval)) {
+        fprintf(stderr, "Error: --snapshot-interval must be a positive whole number of time units, not %s\n", snapshotInterval);
+        printUsage(argv[0]);
+        return 1;
+    }
 
-    // delete all PCBs from ready and resource queues, then delete the running process
-    // (NOTE: all of these should be empty though)
-    for(int i = 0; i < 6; i++) {
-        // display msg if it's not empty
-        if(queues[i] != NULL) {
-            fprintf(stderr, "Error: queue %d should be empty, but isn't\n", i);
+    // a query just asks a daemon (the "input file" is the query)
+    if(querySocket != NULL) {
+        if(path == NULL) {
+            fprintf(stderr, "Error: --query needs a query\n");
+            printUsage(argv[0]);
+            return 1;
         }
-        deleteQueue(&queues[i]);
-    }
-    // display msg if it's not empty
-    if(runningProcess != NULL) {
-        fprintf(stderr, "Error: there shouldn't be a running process, but there is\n");
+        return queryDaemon(querySocket, path);
     }
-    deletePCB(&runningProcess);
-
-    // display program output (first idle time, then all completed processes' times)
-    printf("0 %d\n", idleTime);
-    printQueue(&queues[6]);
 
-    // delete all finished processes after printing, before exiting program
-    deleteQueue(&queues[6]);
-    if(queues[6] != NULL) {
-        fprintf(stderr, "Error: done queue should be empty, but isn't\n");
+    if(tracePath != NULL && (daemonSocket != NULL || batchSource != NULL || outDir != NULL)) {
+        fprintf(stderr, "Error: --trace only works for a single run\n");
+        printUsage(argv[0]);
+        return 1;
     }
 
-    return 0;
-}
-
-// ============================ LINKED LIST FUNCTIONS =============================
-
-/**
- * Creates and initializes the process control block
- * @param int currTime -the current time when it's created
- * @param int pid -its process ID
- * @return an allocated and initialized PCB
- */
-PCB* createPCB(int currTime, int pid) {
-    // create PCB
-    PCB *new = NULL;
-    new = malloc(sizeof(PCB));
-    // init values
-    new->runTime = new->readyTime = new->blockTime = 0;
-    new->prevTime = currTime;
-    new->pid = pid;
-    new->status = NEW;
-    new->next = NULL;
-    return new;
-}
-/**
- * Deletes (Frees) a process, sets it to NULL after freeing
- * @param PCB **toDelete -the PCB to be deleted
- */
-void deletePCB(PCB **toDelete) {
-    // make sure it exists first
-    if(*toDelete == NULL) {
-        return;
+    if(pipelined && (daemonSocket != NULL || batchSource != NULL || outDir != NULL || checkpointPath != NULL)) {
+        fprintf(stderr, "Error: --pipeline only works for a single run without --checkpoint\n");
+        printUsage(argv[0]);
+        return 1;
     }
-    free(*toDelete);
-    *toDelete = NULL;
-}
-/**
- * Deletes (Frees) a queue of processes
- * @param PCB **queue -the the queue to be deleted
- */
-void deleteQueue(PCB **queue) {
-    // make sure it exists first
-    if((*queue) == NULL) {
-        return;
-    }
-    // free all nodes in list, then set tail and head to NULL
-    while((*queue) != NULL) {
-        PCB *temp = (*queue);
-        (*queue) = (*queue)->next;
-        deletePCB(&temp);
-    }
-    (*queue) = NULL;   // reset queue ptr (just in case)
-}
 
-/**
- * Adds a process to the back of a queue
- * @param PCB **queue -the queue being added to
- * @param PCB *toAdd -the process being added
- */
-void pushBack(PCB **queue, PCB *toAdd) {
-    // make sure process given is valid
-    if(toAdd == NULL) {
-        return;
-    }
-    // if it's empty, set as first node in list
-    if((*queue) == NULL) { 
-        (*queue) = toAdd;
-        return;
+    if(config.sample > 0 && config.stream) {
+        fprintf(stderr, "Error: --sample doesn't work with --stream (which keeps no finished processes anyway)\n");
+        printUsage(argv[0]);
+        return 1;
     }
-    // traverse to end of queue and add the node there (queue pointer remains the same)
-    PCB *q = (*queue);
-    while(q->next != NULL) {
-        q = q->next;
-    }
-    q->next = toAdd;
-}
 
-/**
- * Adds a process to a queue, sorted by process ID (ascending order)
- * @param PCB **queue -the queue being added to
- * @param PCB *toAdd -the process being added
- */
-void insertSorted(PCB **queue, PCB *toAdd) {
-    // make sure process given is valid
-    if(toAdd == NULL) {
-        return;
-    }
-    // if it's empty, set as first node in list
-    if((*queue) == NULL) { 
-        (*queue) = toAdd;
-        return;
+    if(stats && !STATS_BUILT) {
+        fprintf(stderr, "Error: --stats needs a build with the counters in it (make clean && make STATS=1)\n");
+        return 1;
     }
 
-    // check if it's the first (or only) element
-    if(toAdd->pid < (*queue)->pid) {
-        toAdd->next = (*queue);
-        (*queue) = toAdd;
-        return;
-    } 
-    // otherwise, traverse to end of queue and add the node there (queue pointer remains the same)
-    PCB *q = (*queue);
-    PCB *prev = q;
-    while(q->next != NULL) {
-        if(toAdd->pid < q->pid) {
-            // add it since it's less than the next node
-            prev->next = toAdd;
-            toAdd->next = q;
-            return;
+    // daemon mode takes the input as it arrives instead
+    if(daemonSocket != NULL) {
+        int status = runDaemon(daemonSocket, path, format, &config);
+        if(stats) {
+            printStats(stderr, stats == 2);
         }
-        prev = q;
-        q = q->next;
-    }
-    // check if it's less than the last element
-    if(toAdd->pid < q->pid) {
-        prev->next = toAdd;
-        toAdd->next = q;
-        return;
+        return status;
     }
-    // otherwise, it's the highest pid and goes on the end
-    q->next = toAdd;
-}
 
-/**
- * Pops and gets the front-most element of a queue
- * @param PCB **queue -the queue being accessed
- * @return the front-most element of the queue (not attached to the queue anymore),
- *          or NULL if not found
- */
-PCB* popFront(PCB **queue) {
-    // if it's empty, return NULL to indicate so
-    if((*queue) == NULL) {
-        return NULL;
-    }
-    // pop first node and reset the front of the queue
-    PCB *toReturn = (*queue);
-    (*queue) = (*queue)->next;
-    toReturn->next = NULL;
-    return toReturn;
-}
-/**
- * Pops and gets the process designated by process ID from a queue
- * @param PCB **queue -the queue being accessed
- * @param int pid -the process ID to be removed from the queue
- * @return the process designated by the given ID (not attached to the queue anymore),
- *          or NULL if it's empty or not found
- */
-PCB* popID(PCB **queue, int pid) {
-    // if it's empty, return NULL to indicate so
-    if((*queue) == NULL) {
-        return NULL;
+    // batch mode replays every file in the batch instead
+    if(batchSource != NULL || outDir != NULL) {
+        if(batchSource == NULL || path != NULL) {
+            fprintf(stderr, "Error: batch mode needs --batch and no input file\n");
+            printUsage(argv[0]);
+            return 1;
+        }
+        int status = runBatch(batchSource, jobs < 1 ? 1 : jobs, outDir, format, &config);
+        if(stats) {
+            printStats(stderr, stats == 2);
+        }
+        return status;
     }
 
-    // check if it's the first (or only) element
-    if((*queue)->pid == pid) {
-        return popFront(queue);
+    // open the input (a file if one is given, otherwise stdin)
+    EventReader reader;
+    if(!openReader(&reader, path, format)) {
+        fprintf(stderr, "Error: could not open input file %s\n", path);
+        return 1;
     }
-    // otherwise, loop through and search for the process (queue pointer remains the same)
-    PCB *q = (*queue);
-    PCB *prev = q;
-    while(q != NULL) {
-        if(q->pid == pid) {
-            // it's a match, so pop it
-            prev->next = q->next;
-            q->next = NULL;
-            return q;
-        }
-        prev = q;
-        q = q->next;
-    }
-    return NULL;    // pid wasn't found
-}
 
-/**
- * Prints the info of each process in the queue
- *  --> Format: <process id> <total time Running> <total time Ready> <total time Blocked>
- * @param PCB **queue -the queue to be printed
- */
-void printQueue(PCB **queue) {
-    // make sure it's not empty
-    if((*queue) == NULL) {
-        return;
+    // start fresh, or from where a checkpoint left off
+    Dispatcher d;
+    Event *batch = malloc(EVENT_BATCH * sizeof(Event));
+    long long events = 0;
+    if(resumePath == NULL) {
+        initDispatcher(&d, &config);
+    } else if(!loadCheckpoint(resumePath, &d, &reader, &events)) {
+        closeReader(&reader);
+        free(batch);
+        return 1;
     }
-    // loop through and print each process' info
-    PCB *curr = (*queue);
-    while(curr != NULL) {
-        printf("%d %d %d %d\n", curr->pid, curr->runTime, curr->readyTime, curr->blockTime);
-        curr = curr->next;
+    d.strict = config.strict;   // not part of the saved setup, since it doesn't change the state
+    if(tracePath != NULL && (d.trace = openTraceSink(tracePath, (size_t)traceBuffer, unitNs)) == NULL) {
+        fprintf(stderr, "Error: could not write trace file %s\n", tracePath);
+        closeReader(&reader);
+        free(batch);
+        deleteDispatcher(&d);
+        return 1;
     }
-}
 
-// =============================== HELPER FUNCTIONS ===============================
-
-/**
- * Helper that parses an input line (assuming there are no errors) storing in appropriate variables
- * @param char* line -the input line being parsed
- * @param int *prevTime -will hold the most recent time
- * @param int *currTime -will hold the parsed time
- * @param char *event -will hold the parsed event
- * @param int *resourceNum -will hold the resource number if event is 'R' or 'I', otherwise -1
- * @param int *pid -will hold the process ID (-1 if event is 'T')
- */
-void parseInputLine(char* line, int *prevTime, int *currTime, char *event, int *resourceNum, int *pid) {
-    // declare var for parsing input lines
-    char *token;
-    
-    // parse time
-    *prevTime = *currTime; // keep track of this to calculate difference
-    token = strtok(line, " ");
-    *currTime = atoi(token);
-
-    // parse event
-    token = strtok(NULL, " ");
-    *event = token[0];
-
-    // parse resource number - only if the event is 'R' or 'I'
-    if(*event == 'R' || *event == 'I') {
-        token = strtok(NULL, " ");
-        *resourceNum = atoi(token);
+    // continue getting input until a blank line is entered (or the input ends), a batch at
+    // a time (which ends at each checkpoint, so it's saved right after the last event read)
+    // (or, pipelined, with the reading and writing on their own threads)
+    int wanted, count;
+    if(pipelined) {
+        if(!runPipeline(&d, &reader)) {
+            fprintf(stderr, "Error: could not start the pipeline's threads\n");
+            closeReader(&reader);
+            free(batch);
+            if(d.trace != NULL) {
+                closeTraceSink(d.trace);
+            }
+            deleteDispatcher(&d);
+            return 1;
+        }
     } else {
-        *resourceNum = -1;
+        do {
+            wanted = EVENT_BATCH;
+            if(checkpointPath != NULL && checkpointEvery - events % checkpointEvery < wanted) {
+                wanted = (int)(checkpointEvery - events % checkpointEvery);
+            }
+            count = nextEvents(&reader, batch, wanted);
+            processEvents(&d, batch, count);
+            events += count;
+            if(checkpointPath != NULL && count > 0 && events % checkpointEvery == 0) {
+                saveCheckpoint(checkpointPath, &d, &reader, events);
+            }
+        } while(count == wanted);
     }
-
-    // parse process ID - check if the event is 'T', in which case there isn't one
-    if(*event != 'T') {
-        token = strtok(NULL, " ");
-        *pid = atoi(token);
-    } else {
-        *pid = -1;
+    closeReader(&reader);
+    free(batch);
+
+    // display program output (first idle time, then all completed processes' times by ID)
+    printResults(&d, stdout);
+    if(d.trace != NULL) {
+        long long dropped = closeTraceSink(d.trace);
+        if(dropped > 0) {
+            fprintf(stderr, "Notice: %lld transitions were left out of the trace (it couldn't keep up, see --trace-buffer)\n", dropped);
+        }
     }
+    deleteDispatcher(&d);
+    if(stats) {
+        printStats(stderr, stats == 2);
+    }
+
+    return 0;
 }
 
 // ================================== MY HELPERS ==================================
 
 /**
- * Flushes all leftover data in the stdin stream
- * @param char* input -the string that was just read from stdin
+ * Prints how to run the program
+ * @param char *program -the name the program was run as
  */
-void flushInput(char* input) {
-    // if the '\n' is NOT found in the word itself, flush the stream (null-terminate the input regardless)
-    if(strchr(input, '\n') == NULL) {
-        while ((getchar()) != '\n');
-        input[strlen(input)] = '\0';
-    } else {
-        input[strlen(input)-1] = '\0';
-    }
+void printUsage(char *program) {
+    fprintf(stderr, "Usage: %s [--input-format=text|bin] [--policy=fifo|priority|srt|mlfq|stride]\n"
+                    "       [--cpus=N] [--balance=global|push|steal] [--resources=N]\n"
+                    "       [--time-unit=s|ms|us|ns] [--stream] [--snapshot-interval=N[s|ms|us|ns]] [--latency]\n"
+                    "       [--trace=FILE [--trace-buffer=N]] [--pipeline] [--strict|--fast] [--stats[=json]]\n"
+                    "       [--sample=N] [--checkpoint=FILE [--checkpoint-every=N]] [--resume=FILE] [input file]\n"
+                    "       %s [options] --batch=LIST|DIR [--jobs=N] [--out-dir=DIR]\n"
+                    "       %s [options] --daemon=SOCKET [input file or FIFO]\n"
+                    "       %s --query=SOCKET \"pid N\"|totals|shutdown\n", program, program, program, program);
 }
@@ -0,0 +1,491 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Process control blocks, the queues they move between, and the process ID index
+ */
+
+// =================================== INCLUDES ===================================
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pcb.h"
+#include "stats.h"
+
+// ================================ TABLE FUNCTIONS ===============================
+
+/**
+ * Initializes an empty table (no memory is allocated until the first PCB is created)
+ * @param PCBTable *table -the table being initialized
+ */
+void initTable(PCBTable *table) {
+    table->pid = NULL;
+    table->status = NULL;
+    table->prevTime = table->runTime = table->readyTime = table->blockTime = NULL;
+    table->next = table->prev = NULL;
+    table->info = NULL;
+    table->capacity = table->used = 0;
+    table->freeList = NO_SLOT;
+}
+/**
+ * Deletes (Frees) a table, releasing every PCB it ever handed out in one go
+ * --> any slot still referenced anywhere is invalid afterwards
+ * @param PCBTable *table -the table to be deleted
+ */
+void deleteTable(PCBTable *table) {
+    free(table->pid);
+    free(table->status);
+    free(table->prevTime);
+    free(table->runTime);
+    free(table->readyTime);
+    free(table->blockTime);
+    free(table->next);
+    free(table->prev);
+    free(table->info);
+    initTable(table);
+}
+
+/**
+ * Creates and initializes the process control block
+ * --> reuses a freed slot if there is one, otherwise takes the next unused slot (doubling
+ *     every array when they're full)
+ * @param PCBTable *table -the table it's allocated in
+ * @param long long currTime -the current time when it's created
+ * @param int pid -its process ID
+ * @return the slot of an allocated and initialized PCB
+ */
+Slot createPCB(PCBTable *table, long long currTime, int pid) {
+    // take a slot
+    STAT_ADD(STAT_PCB_ALLOCS, 1);
+    Slot new;
+    if(table->freeList != NO_SLOT) {
+        new = table->freeList;
+        table->freeList = table->next[new];
+    } else {
+        if(table->used == table->capacity) {
+            Slot capacity = table->capacity == 0 ? 256 : table->capacity * 2;
+            STAT_ADD(STAT_GROWS, 1);
+            table->pid = realloc(table->pid, capacity * sizeof(int));
+            table->status = realloc(table->status, capacity * sizeof(uint8_t));
+            table->prevTime = realloc(table->prevTime, capacity * sizeof(long long));
+            table->runTime = realloc(table->runTime, capacity * sizeof(long long));
+            table->readyTime = realloc(table->readyTime, capacity * sizeof(long long));
+            table->blockTime = realloc(table->blockTime, capacity * sizeof(long long));
+            table->next = realloc(table->next, capacity * sizeof(Slot));
+            table->prev = realloc(table->prev, capacity * sizeof(Slot));
+            table->info = realloc(table->info, capacity * sizeof(PCBInfo));
+            table->capacity = capacity;
+        }
+        new = table->used++;
+    }
+
+    // init values
+    table->runTime[new] = table->readyTime[new] = table->blockTime[new] = 0;
+    table->prevTime[new] = currTime;
+    table->pid[new] = pid;
+    table->status[new] = NEW;
+    table->next[new] = table->prev[new] = NO_SLOT;
+    PCBInfo *info = &table->info[new];
+    info->cpu = -1;
+    info->resource = 0;
+    info->runStart = currTime;
+    info->owner = NULL;
+    info->priority = info->level = info->quantumUsed = 0;
+    info->burstEstimate = info->burstBase = 0;
+    info->heapIndex = -1;
+    info->sortKey = info->seq = info->pass = 0;
+    return new;
+}
+/**
+ * Deletes (Frees) a process back to its table, so its slot can be reused
+ * @param PCBTable *table -the table it was allocated in
+ * @param Slot toDelete -the PCB to be deleted (nothing happens for NO_SLOT)
+ */
+void deletePCB(PCBTable *table, Slot toDelete) {
+    // make sure it exists first
+    if(toDelete == NO_SLOT) {
+        return;
+    }
+    STAT_ADD(STAT_PCB_FREES, 1);
+    table->next[toDelete] = table->freeList;
+    table->freeList = toDelete;
+}
+
+// ============================ LINKED LIST FUNCTIONS =============================
+
+/**
+ * Initializes an empty queue
+ * @param Queue *queue -the queue being initialized
+ */
+void initQueue(Queue *queue) {
+    queue->head = queue->tail = NO_SLOT;
+    queue->length = 0;
+}
+/**
+ * Deletes (Frees) a queue of processes, freeing them back to their table
+ * @param PCBTable *table -the table the processes were allocated in
+ * @param Queue *queue -the the queue to be deleted
+ */
+void deleteQueue(PCBTable *table, Queue *queue) {
+    Slot temp;
+    while((temp = popFront(table, queue)) != NO_SLOT) {
+        deletePCB(table, temp);
+    }
+    initQueue(queue);   // reset queue (just in case)
+}
+
+/**
+ * Adds a process to the back of a queue
+ * @param PCBTable *table -the table the process is in
+ * @param Queue *queue -the queue being added to
+ * @param Slot toAdd -the process being added
+ */
+void pushBack(PCBTable *table, Queue *queue, Slot toAdd) {
+    // make sure process given is valid
+    if(toAdd == NO_SLOT) {
+        return;
+    }
+    STAT_ADD(STAT_PUSH_BACK, 1);
+    table->next[toAdd] = NO_SLOT;
+    table->prev[toAdd] = queue->tail;
+    table->info[toAdd].owner = queue;
+    // if it's empty, set as first node in list, otherwise attach it after the tail
+    if(queue->tail == NO_SLOT) {
+        queue->head = toAdd;
+    } else {
+        table->next[queue->tail] = toAdd;
+    }
+    queue->tail = toAdd;
+    queue->length++;
+}
+
+/**
+ * Removes a process from the queue it's in
+ * @param PCBTable *table -the table the process is in
+ * @param Queue *queue -the queue being accessed
+ * @param Slot toRemove -the process being removed (must be in the given queue)
+ */
+void removePCB(PCBTable *table, Queue *queue, Slot toRemove) {
+    STAT_ADD(STAT_REMOVE_PCB, 1);
+    Slot next = table->next[toRemove], prev = table->prev[toRemove];
+    if(prev != NO_SLOT) {
+        table->next[prev] = next;
+    } else {
+        queue->head = next;
+    }
+    if(next != NO_SLOT) {
+        table->prev[next] = prev;
+    } else {
+        queue->tail = prev;
+    }
+    table->next[toRemove] = table->prev[toRemove] = NO_SLOT;
+    table->info[toRemove].owner = NULL;
+    queue->length--;
+}
+
+/**
+ * Pops and gets the front-most element of a queue
+ * @param PCBTable *table -the table the processes are in
+ * @param Queue *queue -the queue being accessed
+ * @return the front-most element of the queue (not attached to the queue anymore),
+ *          or NO_SLOT if it's empty
+ */
+Slot popFront(PCBTable *table, Queue *queue) {
+    // if it's empty, return NO_SLOT to indicate so
+    if(queue->head == NO_SLOT) {
+        return NO_SLOT;
+    }
+    STAT_ADD(STAT_POP_FRONT, 1);
+    Slot toReturn = queue->head;
+    removePCB(table, queue, toReturn);
+    return toReturn;
+}
+/**
+ * Pops and gets the process designated by process ID from a queue
+ * --> O(1): the process is found via the index, then unlinked using its own prev/next
+ * @param PCBTable *table -the table the processes are in
+ * @param PIDIndex *index -the index of all live processes
+ * @param Queue *queue -the queue being accessed
+ * @param int pid -the process ID to be removed from the queue
+ * @return the process designated by the given ID (not attached to the queue anymore),
+ *          or NO_SLOT if it's empty or not found
+ */
+Slot popID(PCBTable *table, PIDIndex *index, Queue *queue, int pid) {
+    // find the process, and make sure it's actually in this queue
+    STAT_ADD(STAT_POP_ID, 1);
+    Slot toReturn = indexFind(index, pid);
+    if(toReturn == NO_SLOT || table->info[toReturn].owner != queue) {
+        return NO_SLOT;
+    }
+    removePCB(table, queue, toReturn);
+    return toReturn;
+}
+
+/**
+ * Prints the info of each process in the queue
+ *  --> Format: <process id> <total time Running> <total time Ready> <total time Blocked>
+ * @param PCBTable *table -the table the processes are in
+ * @param Queue *queue -the queue to be printed
+ * @param FILE *out -where to print it
+ */
+void printQueue(PCBTable *table, Queue *queue, FILE *out) {
+    // loop through and print each process' info
+    for(Slot curr = queue->head; curr != NO_SLOT; curr = table->next[curr]) {
+        STAT_ADD(STAT_NODES_VISITED, 1);
+        fprintf(out, "%d %lld %lld %lld\n", table->pid[curr], table->runTime[curr], table->readyTime[curr], table->blockTime[curr]);
+    }
+}
+
+// ============================== PCB LIST FUNCTIONS ==============================
+
+/**
+ * Initializes an empty list
+ * @param PCBList *list -the list being initialized
+ */
+void initList(PCBList *list) {
+    list->items = NULL;
+    list->count = list->capacity = 0;
+}
+/**
+ * Deletes (Frees) a list and all the processes in it
+ * @param PCBTable *table -the table the processes were allocated in
+ * @param PCBList *list -the list to be deleted
+ */
+void deleteList(PCBTable *table, PCBList *list) {
+    STAT_ADD(STAT_NODES_VISITED, list->count);
+    for(int i = 0; i < list->count; i++) {
+        deletePCB(table, list->items[i]);
+    }
+    free(list->items);
+    initList(list);
+}
+
+/**
+ * Adds a process to the end of a list, doubling its capacity when it's full
+ * @param PCBList *list -the list being added to
+ * @param Slot toAdd -the process being added
+ */
+void append(PCBList *list, Slot toAdd) {
+    // make sure process given is valid
+    if(toAdd == NO_SLOT) {
+        return;
+    }
+    if(list->count == list->capacity) {
+        list->capacity = list->capacity == 0 ? 64 : list->capacity * 2;
+        STAT_ADD(STAT_GROWS, 1);
+        list->items = realloc(list->items, list->capacity * sizeof(Slot));
+    }
+    list->items[list->count++] = toAdd;
+}
+
+/**
+ * Sorts a list by process ID (ascending order, equal pids keep their order in the list)
+ * --> O(N): nothing to do if it's already sorted, otherwise an LSD radix sort on the
+ *     (non-negative) pid, one byte per pass, skipping bytes that are the same for all
+ * --> the pids are copied out next to their slots first, so the passes don't go back to
+ *     the table for every comparison
+ * @param PCBTable *table -the table the processes are in
+ * @param PCBList *list -the list being sorted
+ */
+void sortByID(PCBTable *table, PCBList *list) {
+    // check if it's already sorted first (e.g. processes exited in order of creation)
+    STAT_ADD(STAT_SORT_BY_ID, 1);
+    STAT_ADD(STAT_NODES_VISITED, list->count);
+    int sorted = 1;
+    for(int i = 1; i < list->count && sorted; i++) {
+        sorted = table->pid[list->items[i-1]] <= table->pid[list->items[i]];
+    }
+    if(sorted) {
+        return;
+    }
+
+    PIDEntry *from = malloc(list->count * sizeof(PIDEntry));
+    PIDEntry *to = malloc(list->count * sizeof(PIDEntry));
+    for(int i = 0; i < list->count; i++) {
+        from[i].pid = table->pid[list->items[i]];
+        from[i].slot = list->items[i];
+    }
+    for(int shift = 0; shift < 32; shift += 8) {
+        // count how many of each byte there are, then turn the counts into offsets
+        int offsets[256] = {0};
+        for(int i = 0; i < list->count; i++) {
+            offsets[((unsigned int)from[i].pid >> shift) & 0xff]++;
+        }
+        if(offsets[((unsigned int)from[0].pid >> shift) & 0xff] == list->count) {
+            continue;   // all the same, so this pass wouldn't change anything
+        }
+        for(int i = 0, total = 0; i < 256; i++) {
+            int count = offsets[i];
+            offsets[i] = total;
+            total += count;
+        }
+        // scatter into the other buffer (stable), then swap buffers
+        for(int i = 0; i < list->count; i++) {
+            to[offsets[((unsigned int)from[i].pid >> shift) & 0xff]++] = from[i];
+        }
+        PIDEntry *temp = from;
+        from = to;
+        to = temp;
+    }
+    for(int i = 0; i < list->count; i++) {
+        list->items[i] = from[i].slot;
+    }
+    free(from);
+    free(to);
+}
+
+/**
+ * Prints the info of each process in the list
+ *  --> Format: <process id> <total time Running> <total time Ready> <total time Blocked>
+ * @param PCBTable *table -the table the processes are in
+ * @param PCBList *list -the list to be printed
+ * @param FILE *out -where to print it
+ */
+void printList(PCBTable *table, PCBList *list, FILE *out) {
+    STAT_ADD(STAT_NODES_VISITED, list->count);
+    for(int i = 0; i < list->count; i++) {
+        Slot curr = list->items[i];
+        fprintf(out, "%d %lld %lld %lld\n", table->pid[curr], table->runTime[curr], table->readyTime[curr], table->blockTime[curr]);
+    }
+}
+
+// ============================== PID INDEX FUNCTIONS =============================
+
+/**
+ * Helper that gets the home slot of a process ID (murmur3 fmix32, so every bit of the
+ * pid reaches the masked low bits and pids spaced a power of two apart do not cluster)
+ * @param PIDIndex *index -the index being accessed
+ * @param int pid -the process ID being hashed
+ * @return the first slot to probe for the given process ID
+ */
+static int indexSlot(PIDIndex *index, int pid) {
+    unsigned int h = (unsigned int)pid;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return (int)(h & (unsigned int)(index->capacity - 1));
+}
+
+/**
+ * Initializes an empty process ID index
+ * @param PIDIndex *index -the index being initialized
+ */
+void initIndex(PIDIndex *index) {
+    index->capacity = 64;
+    index->count = 0;
+    index->slots = malloc(index->capacity * sizeof(PIDEntry));
+    for(int i = 0; i < index->capacity; i++) {
+        index->slots[i].slot = NO_SLOT;
+    }
+}
+/**
+ * Deletes (Frees) the index itself (the processes it points to are NOT freed)
+ * @param PIDIndex *index -the index to be deleted
+ */
+void deleteIndex(PIDIndex *index) {
+    free(index->slots);
+    index->slots = NULL;
+    index->capacity = index->count = 0;
+}
+
+/**
+ * Adds a process to the index, doubling the table once it's half full
+ * @param PIDIndex *index -the index being added to
+ * @param int pid -the process's ID
+ * @param Slot toAdd -the process being added
+ * @return 1 if it was added, 0 if a process with the same ID is already indexed
+ */
+int indexInsert(PIDIndex *index, int pid, Slot toAdd) {
+    // make sure process given is valid
+    if(toAdd == NO_SLOT) {
+        return 0;
+    }
+    // grow first, re-inserting everything into the bigger table
+    if((index->count + 1) * 2 > index->capacity) {
+        PIDEntry *old = index->slots;
+        int oldCapacity = index->capacity;
+        index->capacity *= 2;
+        STAT_ADD(STAT_GROWS, 1);
+        index->slots = malloc(index->capacity * sizeof(PIDEntry));
+        for(int i = 0; i < index->capacity; i++) {
+            index->slots[i].slot = NO_SLOT;
+        }
+        for(int i = 0; i < oldCapacity; i++) {
+            if(old[i].slot != NO_SLOT) {
+                int j = indexSlot(index, old[i].pid);
+                while(index->slots[j].slot != NO_SLOT) {
+                    j = (j + 1) & (index->capacity - 1);
+                }
+                index->slots[j] = old[i];
+            }
+        }
+        free(old);
+    }
+
+    // probe for an empty slot, making sure the pid isn't already there
+    int i = indexSlot(index, pid);
+    while(index->slots[i].slot != NO_SLOT) {
+        if(index->slots[i].pid == pid) {
+            return 0;
+        }
+        i = (i + 1) & (index->capacity - 1);
+    }
+    index->slots[i].pid = pid;
+    index->slots[i].slot = toAdd;
+    index->count++;
+    return 1;
+}
+
+/**
+ * Finds a live process by its ID
+ * @param PIDIndex *index -the index being searched
+ * @param int pid -the process ID being searched for
+ * @return the process with the given ID, or NO_SLOT if not found
+ */
+Slot indexFind(PIDIndex *index, int pid) {
+    int i = indexSlot(index, pid);
+    while(index->slots[i].slot != NO_SLOT) {
+        STAT_ADD(STAT_INDEX_PROBES, 1);
+        if(index->slots[i].pid == pid) {
+            return index->slots[i].slot;
+        }
+        i = (i + 1) & (index->capacity - 1);
+    }
+    return NO_SLOT;     // pid wasn't found
+}
+
+/**
+ * Removes a process from the index (the process itself is NOT freed)
+ * --> uses backward-shift deletion so no tombstones are left behind
+ * @param PIDIndex *index -the index being removed from
+ * @param int pid -the process ID to be removed
+ */
+void indexRemove(PIDIndex *index, int pid) {
+    int mask = index->capacity - 1;
+    int i = indexSlot(index, pid);
+    while(index->slots[i].slot != NO_SLOT && index->slots[i].pid != pid) {
+        i = (i + 1) & mask;
+    }
+    if(index->slots[i].slot == NO_SLOT) {
+        return;     // pid wasn't found
+    }
+    index->count--;
+
+    // shift back any later entries in this cluster that would no longer be reachable
+    int j = i;
+    while(1) {
+        index->slots[i].slot = NO_SLOT;
+        int home;
+        do {
+            j = (j + 1) & mask;
+            if(index->slots[j].slot == NO_SLOT) {
+                return;
+            }
+            home = indexSlot(index, index->slots[j].pid);
+        } while(i <= j ? (i < home && home <= j) : (i < home || home <= j));
+        index->slots[i] = index->slots[j];
+        i = j;
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Process control blocks, the queues they move between, and the process ID index
+ */
+
+#ifndef PCB_H
+#define PCB_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// =================================== STRUCTS ====================================
+
+typedef enum pstate { NEW, RUNNING, READY, BLOCKED, TERMINATED } ProcessState;
+
+/**
+ * A process's slot in the PCB table (NO_SLOT for none)
+ */
+typedef uint32_t Slot;
+#define NO_SLOT UINT32_MAX
+
+struct queue_struct;
+
+/**
+ * The rarely scanned part of a process control block (scheduling policy bookkeeping)
+ */
+typedef struct pcb_info_struct {
+    int cpu;                    // CPU it's running on, or whose ready queue it's in / was last on
+    int resource;               // resource number it's blocked on (0 if it isn't blocked)
+    long long runStart;         // when it last started running
+    struct queue_struct *owner; // the queue it's currently in (NULL if it's running or not in one)
+    // scheduling policy bookkeeping (see policy.c)
+    int priority;               // given when it's created, lower is more important
+    int heapIndex;              // position in a heap-based ready queue (-1 if not in one)
+    int level, quantumUsed;     // multilevel feedback queue level, and ticks used there
+    long long burstEstimate, burstBase; // predicted CPU burst, and runTime when this one began
+    long long sortKey, seq, pass;   // ready queue order (key, then arrival), stride pass
+} PCBInfo;
+
+/**
+ * Every simulated process control block, as a structure of arrays indexed by slot
+ * --> the fields every event and the final report use (pid, status, prevTime and the
+ *     three times) each have their own dense array, and everything else is in info
+ * --> queue membership is intrusive and doubly linked through next/prev slot numbers
+ * --> freed slots are reused first (linked through next), and the arrays double in size
+ *     when every slot is in use, so a Slot stays valid while pointers into them may not
+ */
+typedef struct pcb_table_struct {
+    int *pid;
+    uint8_t *status;            // a ProcessState
+    long long *prevTime, *runTime, *readyTime, *blockTime;
+    Slot *next, *prev;
+    PCBInfo *info;
+    Slot capacity;              // slots allocated
+    Slot used;                  // slots ever handed out (the rest have never been used)
+    Slot freeList;              // freed slots, linked through next
+} PCBTable;
+
+/**
+ * A queue of processes
+ * --> keeps both ends and its length so adding to the back is constant time
+ */
+typedef struct queue_struct {
+    Slot head, tail;
+    int length;
+} Queue;
+
+/**
+ * A growable array of processes
+ * --> used for terminated processes, which are only appended until they're reported
+ */
+typedef struct pcb_list_struct {
+    Slot *items;
+    int count, capacity;
+} PCBList;
+
+/**
+ * Maps a process ID to the slot of its (not yet terminated) PCB
+ * --> open addressing, each entry keeps the pid so probing never touches the table
+ */
+typedef struct pid_entry_struct {
+    int pid;
+    Slot slot;                  // NO_SLOT if the entry is empty
+} PIDEntry;
+typedef struct pid_index_struct {
+    PIDEntry *slots;
+    int capacity, count;
+} PIDIndex;
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+void initTable(PCBTable *table);
+void deleteTable(PCBTable *table);
+Slot createPCB(PCBTable *table, long long currTime, int pid);
+void deletePCB(PCBTable *table, Slot toDelete);
+
+void initQueue(Queue *queue);
+void deleteQueue(PCBTable *table, Queue *queue);
+void pushBack(PCBTable *table, Queue *queue, Slot toAdd);
+void removePCB(PCBTable *table, Queue *queue, Slot toRemove);
+Slot popFront(PCBTable *table, Queue *queue);
+Slot popID(PCBTable *table, PIDIndex *index, Queue *queue, int pid);
+void printQueue(PCBTable *table, Queue *queue, FILE *out);
+
+void initList(PCBList *list);
+void deleteList(PCBTable *table, PCBList *list);
+void append(PCBList *list, Slot toAdd);
+void sortByID(PCBTable *table, PCBList *list);
+void printList(PCBTable *table, PCBList *list, FILE *out);
+
+void initIndex(PIDIndex *index);
+void deleteIndex(PIDIndex *index);
+int indexInsert(PIDIndex *index, int pid, Slot toAdd);
+Slot indexFind(PIDIndex *index, int pid);
+void indexRemove(PIDIndex *index, int pid);
+
+#endif
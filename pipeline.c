@@ -0,0 +1,215 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Pipelined replay: a parser thread decodes the input into batches of events, the
+ *     calling thread applies them, and a writer thread writes out whatever they printed
+ *     (streamed times and snapshots), so reading and writing overlap the simulation
+ * --> Each stage hands the next one work through a bounded single-producer single-consumer
+ *     ring (PIPELINE_DEPTH entries): a stage that gets a whole ring ahead waits for the next
+ *     to catch up, so memory stays bounded however large the input is
+ * --> Events are applied one batch at a time in input order by one thread, exactly as the
+ *     serial loop in idispatcher.c does, so the output is the same
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "pipeline.h"
+
+#define SPIN_TRIES 64           // how many times a waiting stage yields before it sleeps
+#define STAGE_IDLE_NS 50000     // how long a waiting stage sleeps after that
+
+// =================================== STRUCTS ====================================
+
+/**
+ * One batch of events, as read from the input
+ */
+typedef struct event_slot_struct {
+    Event *events;
+    int count;                  // fewer than EVENT_BATCH only for the last batch
+} EventSlot;
+
+/**
+ * One chunk of output, as printed while applying one batch
+ */
+typedef struct output_chunk_struct {
+    char *text;
+    size_t size;
+} OutputChunk;
+
+/**
+ * The two rings between the stages
+ * --> each counter is only ever written by one thread (published with release/acquire
+ *     atomics, no locks), and each is on its own cache line
+ */
+typedef struct pipeline_struct {
+    EventSlot slots[PIPELINE_DEPTH];
+    OutputChunk chunks[PIPELINE_DEPTH];
+    EventReader *reader;
+    FILE *out;                  // where the writer writes the chunks
+    char padParsed[64];
+    size_t parsed;              // batches the parser has filled
+    char padApplied[64];
+    size_t applied;             // batches the simulator has applied
+    size_t printed;             // chunks the simulator has added
+    int done;                   // set once the simulator won't add any more chunks
+    char padWritten[64];
+    size_t written;             // chunks the writer has written
+    char padEnd[64];
+} Pipeline;
+
+// ================================== MY HELPERS ==================================
+
+/**
+ * Helper that waits a little for another stage: it gives up the CPU at first, then sleeps
+ * @param int *tries -how many times this stage has waited in a row (updated)
+ */
+static void backOff(int *tries) {
+    if(++*tries < SPIN_TRIES) {
+        sched_yield();
+    } else {
+        struct timespec idle = { 0, STAGE_IDLE_NS };
+        nanosleep(&idle, NULL);
+    }
+}
+
+/**
+ * Helper that runs the parser thread: reads batches of events into the ring until the
+ * input ends
+ * @param void *arg -the pipeline
+ * @return NULL
+ */
+static void* runParser(void *arg) {
+    Pipeline *p = arg;
+    size_t parsed = 0;
+    int count;
+    do {
+        int tries = 0;
+        while(parsed - __atomic_load_n(&p->applied, __ATOMIC_ACQUIRE) == PIPELINE_DEPTH) {
+            backOff(&tries);
+        }
+        EventSlot *slot = &p->slots[parsed % PIPELINE_DEPTH];
+        count = slot->count = nextEvents(p->reader, slot->events, EVENT_BATCH);
+        __atomic_store_n(&p->parsed, ++parsed, __ATOMIC_RELEASE);
+    } while(count == EVENT_BATCH);
+    return NULL;
+}
+
+/**
+ * Helper that runs the writer thread: writes out chunks until the simulator is done and
+ * every chunk it added has been written
+ * @param void *arg -the pipeline
+ * @return NULL
+ */
+static void* runWriter(void *arg) {
+    Pipeline *p = arg;
+    size_t written = 0;
+    int tries = 0;
+    while(1) {
+        if(written == __atomic_load_n(&p->printed, __ATOMIC_ACQUIRE)) {
+            // caught up: stop if nothing more is coming (checking again after done, since
+            // chunks added before it was set might not have been seen yet)
+            if(__atomic_load_n(&p->done, __ATOMIC_ACQUIRE)) {
+                if(written == __atomic_load_n(&p->printed, __ATOMIC_ACQUIRE)) {
+                    break;
+                }
+                continue;
+            }
+            backOff(&tries);
+            continue;
+        }
+        tries = 0;
+        OutputChunk *chunk = &p->chunks[written % PIPELINE_DEPTH];
+        fwrite(chunk->text, 1, chunk->size, p->out);
+        free(chunk->text);
+        __atomic_store_n(&p->written, ++written, __ATOMIC_RELEASE);
+    }
+    fflush(p->out);
+    return NULL;
+}
+
+/**
+ * Helper that hands a chunk of output to the writer, waiting if its ring is full
+ * @param Pipeline *p -the pipeline
+ * @param char *text -the output (the writer frees it)
+ * @param size_t size -its length
+ */
+static void addChunk(Pipeline *p, char *text, size_t size) {
+    int tries = 0;
+    while(p->printed - __atomic_load_n(&p->written, __ATOMIC_ACQUIRE) == PIPELINE_DEPTH) {
+        backOff(&tries);
+    }
+    OutputChunk *chunk = &p->chunks[p->printed % PIPELINE_DEPTH];
+    chunk->text = text;
+    chunk->size = size;
+    __atomic_store_n(&p->printed, p->printed + 1, __ATOMIC_RELEASE);
+}
+
+// ============================== PIPELINE FUNCTIONS ==============================
+
+/**
+ * Applies every event in the input to a dispatcher, with the input read and its output
+ * written on their own threads (the results still have to be printed afterwards)
+ * @param Dispatcher *d -the dispatcher (its output goes where d->out is, which it's reset to)
+ * @param EventReader *reader -the input (not read from again afterwards)
+ * @return 1 if every event was applied, 0 if the threads couldn't be started (nothing was read)
+ */
+int runPipeline(Dispatcher *d, EventReader *reader) {
+    Pipeline *p = calloc(1, sizeof(Pipeline));
+    p->reader = reader;
+    p->out = d->out;
+    for(int i = 0; i < PIPELINE_DEPTH; i++) {
+        p->slots[i].events = malloc(EVENT_BATCH * sizeof(Event));
+    }
+
+    // output is only printed while applying events when streaming or taking snapshots
+    int printing = d->stream || d->snapshotInterval > 0;
+    pthread_t parser, writer;
+    int writing = printing && pthread_create(&writer, NULL, runWriter, p) == 0;
+    int ok = (writing || !printing) && pthread_create(&parser, NULL, runParser, p) == 0;
+    if(ok) {
+        // apply each batch in order, each one's output going to the writer as one chunk
+        int count;
+        do {
+            int tries = 0;
+            while(p->applied == __atomic_load_n(&p->parsed, __ATOMIC_ACQUIRE)) {
+                backOff(&tries);
+            }
+            EventSlot *slot = &p->slots[p->applied % PIPELINE_DEPTH];
+            char *text = NULL;
+            size_t size = 0;
+            if(printing) {
+                d->out = open_memstream(&text, &size);
+            }
+            processEvents(d, slot->events, slot->count);
+            count = slot->count;
+            __atomic_store_n(&p->applied, p->applied + 1, __ATOMIC_RELEASE);
+            if(printing) {
+                fclose(d->out);
+                if(size > 0) {
+                    addChunk(p, text, size);
+                } else {
+                    free(text);
+                }
+            }
+        } while(count == EVENT_BATCH);
+        pthread_join(parser, NULL);
+    }
+    if(writing) {
+        __atomic_store_n(&p->done, 1, __ATOMIC_RELEASE);
+        pthread_join(writer, NULL);
+    }
+
+    d->out = p->out;
+    for(int i = 0; i < PIPELINE_DEPTH; i++) {
+        free(p->slots[i].events);
+    }
+    free(p);
+    return ok;
+}
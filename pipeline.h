@@ -0,0 +1,21 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Pipelined replay: reading the input, applying the events and writing the output each
+ *     run on their own thread
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "events.h"
+#include "dispatcher.h"
+
+#define PIPELINE_DEPTH 16       // how many batches of events/chunks of output can be waiting
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+int runPipeline(Dispatcher *d, EventReader *reader);
+
+#endif
@@ -0,0 +1,437 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Scheduling policies: each one owns the ready queue and decides what runs next
+ *      - fifo: round robin, preempted by every timer interrupt if anything else is ready
+ *      - priority: lowest priority number first, round robin among equals
+ *      - srt: shortest (predicted) remaining CPU burst first, predicted from the measured
+ *             runTime of its earlier bursts (exponential average)
+ *      - mlfq: multilevel feedback queue, demoted after using up a level's quantum,
+ *              everything boosted back to the top level every MLFQ_BOOST_TICKS timer
+ *              interrupts (counted once per interrupt, however many CPUs share the queue)
+ *      - stride: proportional share, tickets given by the priority (see strideOf)
+ */
+
+// =================================== INCLUDES ===================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "policy.h"
+#include "stats.h"
+
+#define MLFQ_LEVELS 4           // level i's quantum is 2^i timer ticks
+#define MLFQ_BOOST_TICKS 100
+#define STRIDE1 (1 << 20)       // stride of a process with one ticket
+
+// ================================ HEAP FUNCTIONS ================================
+
+/**
+ * Helper that checks if a process should come before another in a heap
+ * @param PCBInfo *info -the table's info array
+ * @param Slot a -the first process
+ * @param Slot b -the second process
+ * @return 1 if a has a lower key (or the same key, but arrived first), otherwise 0
+ */
+static int before(PCBInfo *info, Slot a, Slot b) {
+    return info[a].sortKey < info[b].sortKey || (info[a].sortKey == info[b].sortKey && info[a].seq < info[b].seq);
+}
+
+/**
+ * Helper that puts a process at a position in the heap
+ * @param Policy *policy -the policy whose heap is being accessed
+ * @param int i -the position
+ * @param Slot p -the process
+ */
+static void heapSet(Policy *policy, int i, Slot p) {
+    policy->heap[i] = p;
+    policy->table->info[p].heapIndex = i;
+}
+
+/**
+ * Helper that moves the process at a position up or down the heap until it's in order
+ * @param Policy *policy -the policy whose heap is being accessed
+ * @param int i -the position of the process that might be out of order
+ * @param int size -how many processes are in the heap
+ */
+static void heapFix(Policy *policy, int i, int size) {
+    PCBInfo *info = policy->table->info;
+    Slot p = policy->heap[i];
+    // sift up
+    while(i > 0 && before(info, p, policy->heap[(i - 1) / 2])) {
+        heapSet(policy, i, policy->heap[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    // sift down
+    while(2 * i + 1 < size) {
+        int child = 2 * i + 1;
+        if(child + 1 < size && before(info, policy->heap[child + 1], policy->heap[child])) {
+            child++;
+        }
+        if(!before(info, policy->heap[child], p)) {
+            break;
+        }
+        heapSet(policy, i, policy->heap[child]);
+        i = child;
+    }
+    heapSet(policy, i, p);
+}
+
+/**
+ * Helper that adds a process to the heap (its sortKey must already be set)
+ * @param Policy *policy -the policy whose heap is being added to
+ * @param Slot toAdd -the process being added
+ */
+static void heapPush(Policy *policy, Slot toAdd) {
+    STAT_ADD(STAT_HEAP_PUSH, 1);
+    if(policy->count == policy->heapCapacity) {
+        policy->heapCapacity = policy->heapCapacity == 0 ? 64 : policy->heapCapacity * 2;
+        STAT_ADD(STAT_GROWS, 1);
+        policy->heap = realloc(policy->heap, policy->heapCapacity * sizeof(Slot));
+    }
+    heapSet(policy, policy->count, toAdd);
+    heapFix(policy, policy->count, policy->count + 1);
+}
+
+/**
+ * Helper that removes a process from anywhere in the heap
+ * @param Policy *policy -the policy whose heap is being removed from
+ * @param Slot toRemove -the process being removed (must be in the heap)
+ */
+static void heapRemove(Policy *policy, Slot toRemove) {
+    STAT_ADD(STAT_HEAP_REMOVE, 1);
+    int i = policy->table->info[toRemove].heapIndex;
+    int last = policy->count - 1;
+    policy->table->info[toRemove].heapIndex = -1;
+    if(i != last) {
+        heapSet(policy, i, policy->heap[last]);
+        heapFix(policy, i, last);
+    }
+}
+
+/**
+ * Helper that removes the first process from the heap
+ * @param Policy *policy -the policy whose heap is being accessed
+ * @return the process with the lowest key
+ */
+static Slot heapPop(Policy *policy) {
+    Slot toReturn = policy->heap[0];
+    heapRemove(policy, toReturn);
+    return toReturn;
+}
+
+// ================================ FIFO (ROUND ROBIN) ============================
+
+static void fifoEnqueue(Policy *policy, Slot toAdd) {
+    pushBack(policy->table, &policy->levels[0], toAdd);
+}
+static Slot fifoPickNext(Policy *policy) {
+    return popFront(policy->table, &policy->levels[0]);
+}
+static int fifoTick(Policy *policy, Slot running) {
+    return policy->count > 0;
+}
+static void fifoRemove(Policy *policy, Slot toRemove) {
+    removePCB(policy->table, &policy->levels[0], toRemove);
+}
+
+// =================================== PRIORITY ===================================
+
+static void priorityEnqueue(Policy *policy, Slot toAdd) {
+    PCBInfo *info = &policy->table->info[toAdd];
+    info->sortKey = info->priority;
+    heapPush(policy, toAdd);
+}
+static Slot heapPickNext(Policy *policy) {
+    return heapPop(policy);
+}
+static int priorityTick(Policy *policy, Slot running) {
+    PCBInfo *info = policy->table->info;
+    return policy->count > 0 && info[policy->heap[0]].sortKey <= info[running].priority;
+}
+
+// ======================== SRT (SHORTEST REMAINING TIME) =========================
+
+/**
+ * Helper that predicts how much longer a process' current CPU burst will take
+ * --> once a burst has run longer than predicted, the prediction is doubled past it
+ * @param PCBTable *table -the table the process is in
+ * @param Slot p -the process
+ * @return the predicted remaining time of its current CPU burst
+ */
+static long long remainingEstimate(PCBTable *table, Slot p) {
+    PCBInfo *info = &table->info[p];
+    long long ran = table->runTime[p] - info->burstBase;
+    if(ran > 0 && ran >= info->burstEstimate) {
+        info->burstEstimate = 2 * ran;
+    }
+    return info->burstEstimate - ran;
+}
+
+static void srtEnqueue(Policy *policy, Slot toAdd) {
+    policy->table->info[toAdd].sortKey = remainingEstimate(policy->table, toAdd);
+    heapPush(policy, toAdd);
+}
+static int srtTick(Policy *policy, Slot running) {
+    return policy->count > 0 && policy->table->info[policy->heap[0]].sortKey < remainingEstimate(policy->table, running);
+}
+static void srtBlock(Policy *policy, Slot blocked) {
+    // the burst is over, so average it into the prediction for the next one
+    PCBInfo *info = &policy->table->info[blocked];
+    long long ran = policy->table->runTime[blocked] - info->burstBase;
+    info->burstEstimate = (info->burstEstimate + ran) / 2;
+    info->burstBase = policy->table->runTime[blocked];
+}
+static void heapRemoveReady(Policy *policy, Slot toRemove) {
+    heapRemove(policy, toRemove);
+}
+
+// ========================= MLFQ (MULTILEVEL FEEDBACK QUEUE) =====================
+
+static void mlfqEnqueue(Policy *policy, Slot toAdd) {
+    pushBack(policy->table, &policy->levels[policy->table->info[toAdd].level], toAdd);
+}
+static Slot mlfqPickNext(Policy *policy) {
+    for(int i = 0; i < policy->numLevels; i++) {
+        if(policy->levels[i].length != 0) {
+            return popFront(policy->table, &policy->levels[i]);
+        }
+    }
+    return NO_SLOT;
+}
+static void mlfqInterrupt(Policy *policy) {
+    // every so often, move everything back to the top level so nothing starves (the running
+    // processes are moved back as they're ticked)
+    policy->boosted = (++policy->ticks % MLFQ_BOOST_TICKS == 0);
+    if(policy->boosted) {
+        for(int i = 1; i < policy->numLevels; i++) {
+            Slot p;
+            while((p = popFront(policy->table, &policy->levels[i])) != NO_SLOT) {
+                policy->table->info[p].level = policy->table->info[p].quantumUsed = 0;
+                pushBack(policy->table, &policy->levels[0], p);
+            }
+        }
+    }
+}
+static int mlfqTick(Policy *policy, Slot runningSlot) {
+    PCBInfo *running = &policy->table->info[runningSlot];
+    if(policy->boosted) {
+        running->level = running->quantumUsed = 0;
+    }
+
+    // used up its quantum, so move it down a level (and let something else run)
+    if(++running->quantumUsed >= (1 << running->level)) {
+        running->quantumUsed = 0;
+        if(running->level < policy->numLevels - 1) {
+            running->level++;
+        }
+        return policy->count > 0;
+    }
+    // otherwise, only preempt it for something on a higher level
+    for(int i = 0; i < running->level; i++) {
+        if(policy->levels[i].length != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+static void mlfqRemove(Policy *policy, Slot toRemove) {
+    removePCB(policy->table, &policy->levels[policy->table->info[toRemove].level], toRemove);
+}
+
+// ==================================== STRIDE ====================================
+
+/**
+ * Helper that gets how far a process' pass moves each time it's charged for a tick
+ * --> priority 0 (the default) gets 40 tickets, down to 1 ticket for priority 39 or more
+ * @param PCBInfo *p -the process
+ * @return its stride
+ */
+static long long strideOf(PCBInfo *p) {
+    int priority = p->priority < 0 ? 0 : (p->priority > 39 ? 39 : p->priority);
+    return STRIDE1 / (40 - priority);
+}
+
+static void strideEnqueue(Policy *policy, Slot toAdd) {
+    PCBInfo *info = &policy->table->info[toAdd];
+    // don't let a new (or long blocked) process catch up on all the CPU it didn't use
+    if(info->pass < policy->globalPass) {
+        info->pass = policy->globalPass;
+    }
+    info->sortKey = info->pass;
+    heapPush(policy, toAdd);
+}
+static Slot stridePickNext(Policy *policy) {
+    Slot toRun = heapPop(policy);
+    policy->globalPass = policy->table->info[toRun].pass;
+    return toRun;
+}
+static int strideTick(Policy *policy, Slot runningSlot) {
+    PCBInfo *running = &policy->table->info[runningSlot];
+    running->pass += strideOf(running);
+    return policy->count > 0 && policy->table->info[policy->heap[0]].sortKey <= running->pass;
+}
+
+// =============================== POLICY FUNCTIONS ===============================
+
+static const PolicyOps fifoOps = { "fifo", fifoEnqueue, fifoPickNext, NULL, fifoTick, NULL, fifoRemove };
+static const PolicyOps priorityOps = { "priority", priorityEnqueue, heapPickNext, NULL, priorityTick, NULL, heapRemoveReady };
+static const PolicyOps srtOps = { "srt", srtEnqueue, heapPickNext, NULL, srtTick, srtBlock, heapRemoveReady };
+static const PolicyOps mlfqOps = { "mlfq", mlfqEnqueue, mlfqPickNext, mlfqInterrupt, mlfqTick, NULL, mlfqRemove };
+static const PolicyOps strideOps = { "stride", strideEnqueue, stridePickNext, NULL, strideTick, NULL, heapRemoveReady };
+
+static const PolicyOps *allOps[] = { &fifoOps, &priorityOps, &srtOps, &mlfqOps, &strideOps };
+
+/**
+ * Gets the policy kind with the given name
+ * @param const char *name -the name (fifo, priority, srt, mlfq or stride)
+ * @param PolicyKind *kind -will hold the policy kind
+ * @return 1 if it's the name of a policy, otherwise 0
+ */
+int parsePolicyKind(const char *name, PolicyKind *kind) {
+    for(int i = 0; i < (int)(sizeof(allOps) / sizeof(allOps[0])); i++) {
+        if(strcmp(name, allOps[i]->name) == 0) {
+            *kind = (PolicyKind)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Initializes a policy with an empty ready queue
+ * @param Policy *policy -the policy being initialized
+ * @param PolicyKind kind -which policy it is
+ * @param PCBTable *table -the table its processes are in
+ */
+void initPolicy(Policy *policy, PolicyKind kind, PCBTable *table) {
+    policy->kind = kind;
+    policy->table = table;
+    policy->ops = allOps[kind];
+    policy->count = 0;
+    policy->numLevels = kind == MLFQ_POLICY ? MLFQ_LEVELS : 1;
+    policy->levels = malloc(policy->numLevels * sizeof(Queue));
+    for(int i = 0; i < policy->numLevels; i++) {
+        initQueue(&policy->levels[i]);
+    }
+    policy->heap = NULL;
+    policy->heapCapacity = 0;
+    policy->nextSeq = policy->ticks = policy->globalPass = 0;
+    policy->boosted = 0;
+}
+/**
+ * Deletes (Frees) a policy and any processes still in its ready queue
+ * @param Policy *policy -the policy to be deleted
+ */
+void deletePolicy(Policy *policy) {
+    for(int i = 0; i < policy->numLevels; i++) {
+        deleteQueue(policy->table, &policy->levels[i]);
+    }
+    if(policy->heap != NULL) {
+        for(int i = 0; i < policy->count; i++) {
+            deletePCB(policy->table, policy->heap[i]);
+        }
+    }
+    free(policy->levels);
+    free(policy->heap);
+    policy->levels = NULL;
+    policy->heap = NULL;
+    policy->count = policy->numLevels = policy->heapCapacity = 0;
+}
+
+/**
+ * Adds a process that has become ready to the ready queue
+ * @param Policy *policy -the policy in use
+ * @param Slot toAdd -the process being added (already READY)
+ */
+void enqueueReady(Policy *policy, Slot toAdd) {
+    policy->table->info[toAdd].seq = policy->nextSeq++;
+    policy->ops->onEnqueue(policy, toAdd);
+    policy->count++;
+}
+/**
+ * Takes the process that should run next out of the ready queue
+ * @param Policy *policy -the policy in use
+ * @return the process to run, or NO_SLOT if nothing is ready
+ */
+Slot pickNext(Policy *policy) {
+    if(policy->count == 0) {
+        return NO_SLOT;
+    }
+    Slot toRun = policy->ops->pickNext(policy);
+    policy->count--;
+    return toRun;
+}
+/**
+ * Lets the policy know a timer interrupt happened (once per interrupt, before preemptOnTick
+ * for any of the processes running from its ready queue)
+ * @param Policy *policy -the policy in use
+ */
+void noteInterrupt(Policy *policy) {
+    if(policy->ops->onInterrupt != NULL) {
+        policy->ops->onInterrupt(policy);
+    }
+}
+/**
+ * Lets the policy know a timer interrupt happened, and whether it preempts the process
+ * @param Policy *policy -the policy in use
+ * @param Slot running -the running process (its runTime must be up to date)
+ * @return 1 if the running process should be preempted, otherwise 0
+ */
+int preemptOnTick(Policy *policy, Slot running) {
+    return policy->ops->onTick(policy, running);
+}
+/**
+ * Lets the policy know a process has requested a resource
+ * @param Policy *policy -the policy in use
+ * @param Slot blocked -the process (its runTime must be up to date)
+ */
+void noteBlocked(Policy *policy, Slot blocked) {
+    if(policy->ops->onBlock != NULL) {
+        policy->ops->onBlock(policy, blocked);
+    }
+}
+/**
+ * Gets every process in the ready queue, in an order restoreReady can rebuild it from
+ * (each level's queue front to back, or the heap's order)
+ * @param Policy *policy -the policy in use
+ * @param Slot *ready -will hold the processes (must have room for policy->count of them)
+ */
+void listReady(Policy *policy, Slot *ready) {
+    int n = 0;
+    if(policy->heap != NULL) {
+        for(int i = 0; i < policy->count; i++) {
+            ready[n++] = policy->heap[i];
+        }
+        return;
+    }
+    for(int i = 0; i < policy->numLevels; i++) {
+        for(Slot curr = policy->levels[i].head; curr != NO_SLOT; curr = policy->table->next[curr]) {
+            ready[n++] = curr;
+        }
+    }
+}
+/**
+ * Puts a process back in the ready queue just as it was (same level, key and arrival
+ * order), eg. when restoring a checkpoint - processes must be given in listReady's order
+ * @param Policy *policy -the policy in use
+ * @param Slot toAdd -the process being added (already READY, its sortKey/seq/level set)
+ */
+void restoreReady(Policy *policy, Slot toAdd) {
+    if(policy->ops == &fifoOps || policy->ops == &mlfqOps) {
+        pushBack(policy->table, &policy->levels[policy->table->info[toAdd].level], toAdd);
+    } else {
+        heapPush(policy, toAdd);
+    }
+    policy->count++;
+}
+/**
+ * Takes a particular process out of the ready queue
+ * @param Policy *policy -the policy in use
+ * @param Slot toRemove -the process being removed (must be READY in this policy's queue)
+ */
+void removeReady(Policy *policy, Slot toRemove) {
+    policy->ops->remove(policy, toRemove);
+    policy->count--;
+}
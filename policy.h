@@ -0,0 +1,74 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Scheduling policies: each one owns the ready queue and decides what runs next
+ */
+
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "pcb.h"
+
+// =================================== STRUCTS ====================================
+
+typedef enum policy_kind { FIFO_POLICY, PRIORITY_POLICY, SRT_POLICY, MLFQ_POLICY, STRIDE_POLICY } PolicyKind;
+
+struct policy_struct;
+
+/**
+ * What a scheduling policy has to do (one of these per policy kind)
+ *  --> onEnqueue: a process has become ready
+ *  --> pickNext: take the process that should run next out of the ready queue (NO_SLOT if none)
+ *  --> onInterrupt: a timer interrupt, once per ready queue (before onTick for each of its
+ *      running processes, even if there are none)
+ *  --> onTick: a timer interrupt while a process is running, returns 1 to preempt it
+ *  --> onBlock: the process has just requested a resource (its CPU burst is over)
+ *  --> remove: take a particular ready process out of the ready queue
+ */
+typedef struct policy_ops_struct {
+    const char *name;
+    void (*onEnqueue)(struct policy_struct *policy, Slot toAdd);
+    Slot (*pickNext)(struct policy_struct *policy);
+    void (*onInterrupt)(struct policy_struct *policy);
+    int (*onTick)(struct policy_struct *policy, Slot running);
+    void (*onBlock)(struct policy_struct *policy, Slot blocked);
+    void (*remove)(struct policy_struct *policy, Slot toRemove);
+} PolicyOps;
+
+/**
+ * A scheduling policy and its ready queue
+ * --> FIFO uses one queue, MLFQ one queue per level, the others a binary min-heap
+ *     ordered by (sortKey, seq) so equal keys are served in order of arrival
+ */
+typedef struct policy_struct {
+    PolicyKind kind;
+    const PolicyOps *ops;
+    PCBTable *table;        // where its processes are
+    int count;              // how many processes are ready
+    Queue *levels;          // FIFO/MLFQ queues
+    int numLevels;
+    Slot *heap;             // priority/SRT/stride heap
+    int heapCapacity;
+    long long nextSeq;      // arrival order of the next process to become ready
+    long long ticks;        // timer interrupts seen (MLFQ priority boost)
+    int boosted;            // 1 if the current timer interrupt is a priority boost (MLFQ)
+    long long globalPass;   // pass of the last process picked (stride)
+} Policy;
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+int parsePolicyKind(const char *name, PolicyKind *kind);
+void initPolicy(Policy *policy, PolicyKind kind, PCBTable *table);
+void deletePolicy(Policy *policy);
+
+void enqueueReady(Policy *policy, Slot toAdd);
+Slot pickNext(Policy *policy);
+void noteInterrupt(Policy *policy);
+int preemptOnTick(Policy *policy, Slot running);
+void noteBlocked(Policy *policy, Slot blocked);
+void removeReady(Policy *policy, Slot toRemove);
+void listReady(Policy *policy, Slot *ready);
+void restoreReady(Policy *policy, Slot toAdd);
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Hot-path counters and phase timers, for seeing where replay time goes
+ */
+
+// =================================== INCLUDES ===================================
+#include <stdio.h>
+
+#include "stats.h"
+
+#ifdef DISPATCH_STATS
+
+unsigned long long statCounts[NUM_STAT_COUNTERS];
+unsigned long long statCalls[NUM_STAT_PHASES], statTicks[NUM_STAT_PHASES];
+
+static const char *counterNames[NUM_STAT_COUNTERS] = {
+    "events_C", "events_E", "events_R", "events_I", "events_T", "events_invalid",
+    "batched_ticks", "push_back", "pop_front", "pop_id", "remove_pcb", "heap_push", "heap_remove",
+    "sort_by_id", "nodes_visited", "index_probes", "pcb_allocs", "pcb_frees", "grows"
+};
+static const char *phaseNames[NUM_STAT_PHASES] = { "parse", "validate", "transition", "account" };
+
+// ================================ STATS FUNCTIONS ===============================
+
+/**
+ * Prints every counter, then each phase's calls and time, for everything run so far
+ *  --> Format: stats <counter>=<n> ... (one line), then one line per phase:
+ *              stats phase=<phase> calls=<n> <unit>=<total> per_event=<total / events>
+ *  --> or, as JSON, one object: {"counters":{...},"phases":{"<phase>":{...}},"unit":"..."}
+ * @param FILE *out -where to print them
+ * @param int json -1 to print them as JSON, otherwise 0
+ */
+void printStats(FILE *out, int json) {
+    unsigned long long events = 0;
+    for(int i = STAT_C_EVENTS; i <= STAT_INVALID_EVENTS; i++) {
+        events += statCounts[i];
+    }
+
+    fprintf(out, json ? "{\"counters\":{" : "stats");
+    for(int i = 0; i < NUM_STAT_COUNTERS; i++) {
+        fprintf(out, json ? "%s\"%s\":%llu" : "%s%s=%llu", json && i == 0 ? "" : json ? "," : " ",
+                counterNames[i], statCounts[i]);
+    }
+    fprintf(out, json ? "},\"phases\":{" : "\n");
+    for(int i = 0; i < NUM_STAT_PHASES; i++) {
+        double perEvent = events > 0 ? (double)statTicks[i] / events : 0;
+        if(json) {
+            fprintf(out, "%s\"%s\":{\"calls\":%llu,\"total\":%llu,\"per_event\":%.1f}", i == 0 ? "" : ",",
+                    phaseNames[i], statCalls[i], statTicks[i], perEvent);
+        } else {
+            fprintf(out, "stats phase=%s calls=%llu %s=%llu per_event=%.1f\n", phaseNames[i],
+                    statCalls[i], STAT_CLOCK_UNIT, statTicks[i], perEvent);
+        }
+    }
+    if(json) {
+        fprintf(out, "},\"unit\":\"%s\"}\n", STAT_CLOCK_UNIT);
+    }
+}
+
+#else
+
+/**
+ * Prints nothing (this build has no counters, see stats.h)
+ * @param FILE *out -where they'd be printed
+ * @param int json -1 to print them as JSON, otherwise 0
+ */
+void printStats(FILE *out, int json) {
+}
+
+#endif
@@ -0,0 +1,80 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Hot-path counters and phase timers, for seeing where replay time goes
+ * --> Only built with DISPATCH_STATS defined (`make STATS=1`): otherwise every STAT_ macro
+ *     expands to nothing, so a normal build has no trace of them
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+
+// =================================== COUNTERS ===================================
+
+/**
+ * What's counted (the events are in the same order as the dispatcher's event kinds)
+ */
+typedef enum stat_counter {
+    STAT_C_EVENTS, STAT_E_EVENTS, STAT_R_EVENTS, STAT_I_EVENTS, STAT_T_EVENTS, STAT_INVALID_EVENTS,
+    STAT_BATCHED_TICKS,     // timer interrupts applied as part of a run (see processEvents)
+    STAT_PUSH_BACK, STAT_POP_FRONT, STAT_POP_ID, STAT_REMOVE_PCB,
+    STAT_HEAP_PUSH, STAT_HEAP_REMOVE,
+    STAT_SORT_BY_ID,        // sorts of the finished list (once per run)
+    STAT_NODES_VISITED,     // queue and list nodes walked (printing, sorting, deleting)
+    STAT_INDEX_PROBES,      // index slots looked at to find a process ID
+    STAT_PCB_ALLOCS, STAT_PCB_FREES,
+    STAT_GROWS,             // arrays reallocated bigger (the PCB table, index, lists, heaps)
+    NUM_STAT_COUNTERS
+} StatCounter;
+
+/**
+ * What's timed (account is also part of transition, which it's called from)
+ */
+typedef enum stat_phase { PARSE_PHASE, VALIDATE_PHASE, TRANSITION_PHASE, ACCOUNT_PHASE, NUM_STAT_PHASES } StatPhase;
+
+#ifdef DISPATCH_STATS
+
+#define STATS_BUILT 1
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define STAT_CLOCK_UNIT "cycles"
+#define statClock() __rdtsc()
+#else
+#include <time.h>
+#define STAT_CLOCK_UNIT "ns"
+static inline unsigned long long statClock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+#endif
+
+// added to from any thread (batch mode, the pipeline's parser), so atomically
+extern unsigned long long statCounts[NUM_STAT_COUNTERS];
+extern unsigned long long statCalls[NUM_STAT_PHASES], statTicks[NUM_STAT_PHASES];
+
+#define STAT_ADD(counter, n) __atomic_fetch_add(&statCounts[counter], (unsigned long long)(n), __ATOMIC_RELAXED)
+#define STAT_START(start) unsigned long long start = statClock()
+#define STAT_STOP(phase, start) do { \
+        __atomic_fetch_add(&statTicks[phase], statClock() - (start), __ATOMIC_RELAXED); \
+        __atomic_fetch_add(&statCalls[phase], 1, __ATOMIC_RELAXED); \
+    } while(0)
+
+#else
+
+#define STATS_BUILT 0
+#define STAT_ADD(counter, n) ((void)0)
+#define STAT_START(start) ((void)0)
+#define STAT_STOP(phase, start) ((void)0)
+
+#endif
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+void printStats(FILE *out, int json);
+
+#endif
@@ -0,0 +1,51 @@
+#!/bin/bash
+
+# replays each directory of test inputs in batch mode (several files at once), then checks
+# every file's output is the expected output, and the merged report has every file in it
+out=/tmp/idispatcher_batch_tests
+echo "Start batch testing ..."
+for dir in test_inputs pri_test_inputs
+do
+rm -rf "$out" && mkdir -p "$out"
+./idispatcher --batch="$dir" --jobs=4 --out-dir="$out" 2> /dev/null
+for input in "$dir"/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(echo "$dir" | sed 's/inputs/outputs/')/$name.out"
+if cmp -s "$out/$name.in.out" "$expected"; then
+    echo "Batch $dir/$name passed"
+else
+    echo "Batch $dir/$name failed"
+fi
+done
+if [ "$(ls "$dir"/*.in | ./idispatcher --batch=/dev/stdin --jobs=3 2> /dev/null | grep -c '^# ')" \
+    -eq "$(ls "$dir"/*.in | wc -l)" ]; then
+    echo "Batch $dir merged report passed"
+else
+    echo "Batch $dir merged report failed"
+fi
+done
+
+# listed files with the same name can't both have their output in the same directory (the
+# later one is skipped), and a bad binary trace's error goes in its own .err file
+rm -rf "$out" && mkdir -p "$out/b" "$out/results"
+cp test_inputs/test2.in "$out/b/test1.in"
+printf 'test_inputs/test1.in\n%s\n' "$out/b/test1.in" > "$out/list"
+./idispatcher --batch="$out/list" --jobs=2 --out-dir="$out/results" 2> "$out/err"
+if [ $? -eq 1 ] && grep -q "^Error: $out/b/test1.in has the same file name" "$out/err" \
+    && cmp -s "$out/results/test1.in.out" test_outputs/test1.out; then
+    echo "Batch same names passed"
+else
+    echo "Batch same names failed"
+fi
+rm -rf "$out/b" "$out/results" && mkdir -p "$out/b" "$out/results"
+echo "this is not a binary trace at all" > "$out/b/bad.bin"
+./idispatcher --batch="$out/b" --input-format=bin --out-dir="$out/results" 2> "$out/err"
+if grep -q "^Error: input is not a binary event trace" "$out/results/bad.bin.err" && [ ! -s "$out/err" ]; then
+    echo "Batch binary errors passed"
+else
+    echo "Batch binary errors failed"
+fi
+rm -rf "$out"
+## Batch testing is done!
+echo "Batch testing is done!"
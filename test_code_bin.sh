@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# converts every test input to a binary trace, then checks the binary input path gives
+# exactly the same output as the text input path (and the expected output)
+mkdir -p /tmp/idispatcher_bin_tests
+echo "Start binary trace testing ..."
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+trace="/tmp/idispatcher_bin_tests/$name.bin"
+
+./traceconv "$input" "$trace" 2> /dev/null
+if cmp -s <(./idispatcher --input-format=bin "$trace") <(./idispatcher "$input") \
+    && cmp -s <(./idispatcher --input-format=bin < "$trace") <(cat "$expected"); then
+    echo "Binary $name passed"
+else
+    echo "Binary $name failed"
+fi
+done
+rm -rf /tmp/idispatcher_bin_tests
+## Binary testing is done!
+echo "Binary testing is done!"
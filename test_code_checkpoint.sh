@@ -0,0 +1,132 @@
+#!/bin/bash
+
+# checkpoints a run part way through (by running it on the first half of its input), then
+# resumes from the checkpoint with the whole input and checks the output is exactly what
+# an uninterrupted run gives
+dir=/tmp/idispatcher_checkpoint_tests
+rm -rf "$dir" && mkdir -p "$dir"
+echo "Start checkpoint testing ..."
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+half=$(( $(sed '/^[[:space:]]*$/,$d' "$input" | wc -l) / 2 ))
+[ "$half" -lt 1 ] && half=1
+head -n "$half" "$input" > "$dir/half"
+./idispatcher --checkpoint="$dir/ck" --checkpoint-every="$half" "$dir/half" > /dev/null 2>&1
+if cmp -s <(./idispatcher --resume="$dir/ck" "$input" 2> /dev/null) "$expected"; then
+    echo "Checkpoint $name passed"
+else
+    echo "Checkpoint $name failed"
+fi
+done
+
+# generated traces, with every policy and load balancing, in both input formats
+./tracegen --seed=15 --events=20000 --processes=60 --resources=8 > "$dir/gen.in" 2> /dev/null
+./traceconv "$dir/gen.in" "$dir/gen.bin" 2> /dev/null
+head -n 10000 "$dir/gen.in" > "$dir/gen_half.in"
+head -c $((16 + 16 * 10000)) "$dir/gen.bin" > "$dir/gen_half.bin"
+for options in "" "--policy=mlfq --cpus=3" "--policy=stride --cpus=2 --balance=push" \
+    "--policy=srt --cpus=4 --balance=steal --latency" "--policy=priority --stream" "--cpus=2 --sample=50"
+do
+for format in text bin
+do
+ext=$([ "$format" = "text" ] && echo in || echo bin)
+rm -f "$dir/ck"
+./idispatcher --input-format=$format --resources=8 $options --checkpoint="$dir/ck" \
+    --checkpoint-every=10000 "$dir/gen_half.$ext" > "$dir/first" 2> /dev/null
+full="$(./idispatcher --input-format=$format --resources=8 $options "$dir/gen.$ext" 2> /dev/null)"
+resumed="$(./idispatcher --input-format=$format --resume="$dir/ck" "$dir/gen.$ext" 2> /dev/null)"
+# streamed records from before the checkpoint were printed by the first run instead
+if [[ "$options" == *--stream* ]]; then
+    resumed="$(head -n -1 "$dir/first")
+$resumed"
+fi
+if [ -f "$dir/ck" ] && [ "$full" = "$resumed" ]; then
+    echo "Checkpoint generated $format ${options:-default} passed"
+else
+    echo "Checkpoint generated $format ${options:-default} failed"
+fi
+done
+done
+# resuming from a pipe (which can't seek) reads past what was already done instead
+./idispatcher --checkpoint="$dir/ck" --checkpoint-every=10000 "$dir/gen_half.in" > /dev/null 2>&1
+if cmp -s <(cat "$dir/gen.in" | ./idispatcher --resume="$dir/ck" 2> /dev/null) <(./idispatcher "$dir/gen.in" 2> /dev/null); then
+    echo "Checkpoint from a pipe passed"
+else
+    echo "Checkpoint from a pipe failed"
+fi
+# where each field is up to the first CPU's running process, as "name:bytes" in the order
+# checkpoint.c documents and writes them
+layout="magic:8 version:4 policy:4 cpus:4 balance:4 resources:4 stream:4 snapshot:8 latency:4
+    sample:8 format:4 traceversion:4 offset:8 events:8 prevtime:8 currtime:8 nextcpu:4
+    nextsnapshot:8 finished:8 idletime:8 idlesince:8 running:1
+    pid:4 status:4 cpu:4 resource:4 priority:4 level:4 quantum:4"
+# prints the byte offset of a field in that layout
+offsetOf() {
+    local at=0
+    for entry in $layout; do
+        if [ "${entry%:*}" = "$1" ]; then
+            echo $at
+            return
+        fi
+        at=$((at + ${entry#*:}))
+    done
+}
+# prints the little-endian 4-byte integer at an offset of a file
+readInt() {
+    od -An -tu4 -j "$2" -N4 "$1" | tr -d ' '
+}
+
+# a checkpoint with a field out of range (too many CPUs or resources, or a state, CPU,
+# resource or MLFQ level of the first running process) is rejected, saying which
+./idispatcher --resources=8 --policy=mlfq --cpus=2 --checkpoint="$dir/ck" --checkpoint-every=10000 \
+    "$dir/gen_half.in" > /dev/null 2>&1
+# the layout only fits if the first CPU is running a process that's running on it
+if [ "$(readInt "$dir/ck" "$(offsetOf version)")" = 4 ] && [ "$(readInt "$dir/ck" "$(offsetOf cpus)")" = 2 ] \
+        && [ "$(od -An -tu1 -j "$(offsetOf running)" -N1 "$dir/ck" | tr -d ' ')" = 1 ] \
+        && [ "$(readInt "$dir/ck" "$(offsetOf status)")" = 1 ] && [ "$(readInt "$dir/ck" "$(offsetOf cpu)")" = 0 ]; then
+    echo "Checkpoint layout passed"
+else
+    echo "Checkpoint layout failed"
+fi
+for field in "cpus 5000 is corrupt" "resources 70000 is corrupt" "status 7 invalid state" "cpu 1 invalid CPU" \
+        "resource 9 invalid resource" "level 4 invalid MLFQ level"
+do
+set -- $field
+name=$1 value=$2
+shift 2
+cp "$dir/ck" "$dir/bad"
+perl -e 'print pack("V", $ARGV[0])' "$value" | dd of="$dir/bad" bs=1 seek="$(offsetOf "$name")" conv=notrunc 2> /dev/null
+./idispatcher --resume="$dir/bad" "$dir/gen.in" > /dev/null 2> "$dir/err"
+if [ $? -eq 1 ] && grep -q "$*" "$dir/err" && grep -q "corrupt" "$dir/err"; then
+    echo "Checkpoint corrupt ${name} passed"
+else
+    echo "Checkpoint corrupt ${name} failed"
+fi
+done
+
+# a run killed right after a checkpoint (its input still open) has already written
+# everything it streamed before it, so the resumed run carries on exactly where it stopped
+for options in "--stream" "--stream --snapshot-interval=5000"
+do
+rm -f "$dir/ck" "$dir/fifo" && mkfifo "$dir/fifo"
+./idispatcher --resources=8 $options --checkpoint="$dir/ck" --checkpoint-every=10000 "$dir/fifo" > "$dir/first" 2> /dev/null &
+pid=$!
+{ cat "$dir/gen_half.in"; sleep 10; } > "$dir/fifo" &
+feeder=$!
+for i in $(seq 100); do [ -f "$dir/ck" ] && break; sleep 0.1; done
+kill -9 $pid 2> /dev/null
+wait $pid 2> /dev/null
+kill $feeder 2> /dev/null
+wait $feeder 2> /dev/null
+resumed="$(cat "$dir/first"; ./idispatcher --resume="$dir/ck" "$dir/gen.in" 2> /dev/null)"
+if [ -f "$dir/ck" ] && [ "$resumed" = "$(./idispatcher --resources=8 $options "$dir/gen.in" 2> /dev/null)" ]; then
+    echo "Checkpoint killed ${options} passed"
+else
+    echo "Checkpoint killed ${options} failed"
+fi
+done
+rm -rf "$dir"
+## Checkpoint testing is done!
+echo "Checkpoint testing is done!"
@@ -0,0 +1,60 @@
+#!/bin/bash
+
+# checks one CPU gives the expected output on every test, and counts idle time as the
+# original dispatcher did (only the gap before each event that wakes or interrupts it);
+# that with more CPUs each CPU's idle time runs from when it went idle to when it picks up
+# work, however many events happen on the other CPUs in between; and that a shared queue
+# counts each interrupt once
+echo "Start CPU testing ..."
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+if cmp -s <(./idispatcher --cpus=1 "$input" 2> /dev/null) "$expected"; then
+    echo "CPUs $name passed"
+else
+    echo "CPUs $name failed"
+fi
+done
+# idle from 10: the exit at 20 doesn't wake it, so only 20-30 is counted
+if cmp -s <(printf '0 C 1\n10 R 1 1\n20 E 1\n30 C 2\n40 E 2\n' | ./idispatcher 2> /dev/null) \
+          <(printf '0 10\n1 10 0 10\n2 10 0 0\n'); then
+    echo "CPUs one idle passed"
+else
+    echo "CPUs one idle failed"
+fi
+# idle from 10: 10-20 and 20-30 (interrupts, applied in one step), 40-50 and 50-60
+if cmp -s <(printf '0 C 1\n10 R 1 1\n20 T\n30 T\n40 E 1\n50 T\n60 C 2\n70 E 2\n' | ./idispatcher 2> /dev/null) \
+          <(printf '0 40\n1 10 0 30\n2 10 0 0\n'); then
+    echo "CPUs one idle ticks passed"
+else
+    echo "CPUs one idle ticks failed"
+fi
+if cmp -s <(printf '100 C 1\n200 C 2\n300 E 1\n400 E 2\n' | ./idispatcher --cpus=2 2> /dev/null) \
+          <(printf '0 100 200\n1 200 0 0\n2 200 0 0\n'); then
+    echo "CPUs idle passed"
+else
+    echo "CPUs idle failed"
+fi
+if cmp -s <(printf '100 C 1\n200 C 2\n300 R 1 1\n400 T\n500 I 1 1\n600 E 2\n700 E 1\n' | ./idispatcher --cpus=2 2> /dev/null) \
+          <(printf '0 300 200\n1 400 0 200\n2 400 0 0\n'); then
+    echo "CPUs idle blocked passed"
+else
+    echo "CPUs idle blocked failed"
+fi
+# with one ready queue shared by every CPU, MLFQ counts each timer interrupt once towards
+# its priority boost: 1 and 2 are at the bottom level from 70 (quantum 8, used up at 150,
+# 230, ..., 470), and aren't boosted before interrupt 100; 3 comes at 505 and preempts 1
+# at 510, then at 520 is picked again over 1 (one level up), so 1 only runs again once 3
+# exits (counting each interrupt per CPU would boost at 500, and run 1 again at 520)
+{ echo "0 C 1"; echo "0 C 2"; for t in $(seq 10 10 520); do echo "$t T"; [ $t = 500 ] && echo "505 C 3"; done
+  echo "525 E 3"; echo "530 E 1"; echo "535 E 2"; } > /tmp/idispatcher_cpus.in
+if cmp -s <(./idispatcher --policy=mlfq --cpus=2 /tmp/idispatcher_cpus.in 2> /dev/null) \
+          <(printf '0 0 0\n1 515 15 0\n2 535 0 0\n3 15 5 0\n'); then
+    echo "CPUs mlfq boost passed"
+else
+    echo "CPUs mlfq boost failed"
+fi
+rm -f /tmp/idispatcher_cpus.in
+## CPU testing is done!
+echo "CPU testing is done!"
@@ -0,0 +1,96 @@
+#!/bin/bash
+
+# runs the daemon on a FIFO, feeding it a test input in two halves and querying it over
+# its control socket in between, then checks its final output is the expected output
+dir=/tmp/idispatcher_daemon_tests
+echo "Start daemon testing ..."
+
+# waits until the daemon has applied a number of events (gives up after about 5s)
+wait_for_events() {
+    for try in $(seq 50); do
+        if ./idispatcher --query="$dir/ctl" totals 2> /dev/null | grep -q "^events=$1$"; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    return 1
+}
+
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+rm -rf "$dir" && mkdir -p "$dir" && mkfifo "$dir/in"
+
+# only the events before the blank line that ends the input
+sed '/^[[:space:]]*$/,$d' "$input" > "$dir/events"
+total=$(wc -l < "$dir/events")
+half=$((total / 2))
+
+./idispatcher --daemon="$dir/ctl" "$dir/in" > "$dir/out" 2> /dev/null &
+daemon=$!
+exec 3> "$dir/in"
+head -n "$half" "$dir/events" >&3
+ok=1
+wait_for_events "$half" || ok=0
+
+# the first process must be known while its input is still open
+pid=$(head -n 1 "$dir/events" | tr -d '\r' | awk '{print $3}')
+./idispatcher --query="$dir/ctl" "pid $pid" | grep -q "^pid=$pid " || ok=0
+./idispatcher --query="$dir/ctl" "bogus" | grep -q "^error" || ok=0
+
+tail -n +"$((half + 1))" "$dir/events" >&3
+exec 3>&-
+wait "$daemon"
+
+if [ "$ok" -eq 1 ] && cmp -s "$dir/out" "$expected"; then
+    echo "Daemon $name passed"
+else
+    echo "Daemon $name failed"
+fi
+done
+
+# a shutdown query stops it early, with the results so far
+rm -rf "$dir" && mkdir -p "$dir" && mkfifo "$dir/in"
+./idispatcher --daemon="$dir/ctl" "$dir/in" > "$dir/out" 2> /dev/null &
+daemon=$!
+exec 3> "$dir/in"
+echo "10 C 1" >&3
+if wait_for_events 1 && ./idispatcher --query="$dir/ctl" shutdown | grep -q "^ok$" \
+    && wait "$daemon" && [ "$(head -n 1 "$dir/out")" = "0 10" ]; then
+    echo "Daemon shutdown passed"
+else
+    echo "Daemon shutdown failed"
+fi
+exec 3>&-
+
+# a client that keeps sending queries but never reads the answers doesn't hold up the
+# input or other clients
+if command -v perl > /dev/null; then
+rm -rf "$dir" && mkdir -p "$dir" && mkfifo "$dir/in"
+sed '/^[[:space:]]*$/,$d' test_inputs/test3.in > "$dir/events"
+./idispatcher --daemon="$dir/ctl" "$dir/in" > "$dir/out" 2> /dev/null &
+daemon=$!
+exec 3> "$dir/in"
+wait_for_events 0
+perl -MIO::Socket::UNIX -e '$s = IO::Socket::UNIX->new(Peer => $ARGV[0]) or exit 1;
+    print $s "totals\n" while 1' "$dir/ctl" 2> /dev/null 3>&- &
+flood=$!
+sleep 1
+cat "$dir/events" >&3
+ok=1
+wait_for_events "$(wc -l < "$dir/events")" || ok=0
+exec 3>&-
+for try in $(seq 50); do kill -0 "$daemon" 2> /dev/null || break; sleep 0.1; done
+kill -0 "$daemon" 2> /dev/null && ok=0 && kill "$daemon"
+kill "$flood" 2> /dev/null
+wait "$flood" 2> /dev/null
+if [ "$ok" -eq 1 ] && cmp -s "$dir/out" test_outputs/test3.out; then
+    echo "Daemon unread answers passed"
+else
+    echo "Daemon unread answers failed"
+fi
+fi
+rm -rf "$dir"
+## Daemon testing is done!
+echo "Daemon testing is done!"
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+# checks --fast (no validation) gives the expected output on every test, and the same
+# output as --strict on generated traces (which are always valid) under each policy
+echo "Start fast testing ..."
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+if cmp -s <(./idispatcher --fast "$input" 2> /dev/null) "$expected"; then
+    echo "Fast $name passed"
+else
+    echo "Fast $name failed"
+fi
+done
+./tracegen --seed=3110 --events=100000 --processes=500 --resources=8 /tmp/idispatcher_fast.in 2> /dev/null
+for policy in fifo priority srt mlfq stride
+do
+if cmp -s <(./idispatcher --fast --policy=$policy --cpus=3 --balance=steal --resources=8 /tmp/idispatcher_fast.in 2>&1) \
+          <(./idispatcher --strict --policy=$policy --cpus=3 --balance=steal --resources=8 /tmp/idispatcher_fast.in 2>&1); then
+    echo "Fast $policy passed"
+else
+    echo "Fast $policy failed"
+fi
+done
+# and a trace whose blocked processes are only unblocked when nothing else can happen
+if ./tracegen --seed=11 --events=1000 --processes=2 --interrupt=0 /tmp/idispatcher_fast.in 2> /dev/null \
+    && cmp -s <(./idispatcher --fast /tmp/idispatcher_fast.in 2>&1) <(./idispatcher --strict /tmp/idispatcher_fast.in 2>&1); then
+    echo "Fast no interrupts passed"
+else
+    echo "Fast no interrupts failed"
+fi
+rm -f /tmp/idispatcher_fast.in
+## Fast testing is done!
+echo "Fast testing is done!"
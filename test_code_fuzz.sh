@@ -0,0 +1,27 @@
+#!/bin/bash
+
+# checks the fuzz target gets through every test (as text and as a binary trace) and
+# some mangled input without its state checks failing, then runs the differential test
+# against the reference dispatcher for a few seconds
+echo "Start fuzz testing ..."
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+./traceconv "$input" /tmp/idispatcher_fuzz.bin 2> /dev/null
+head -c 200 /dev/urandom > /tmp/idispatcher_fuzz.rand
+if ./fuzz/fuzz_dispatcher "$input" /tmp/idispatcher_fuzz.bin 2> /dev/null \
+    && tr '0-9' '1-90' < "$input" | ./fuzz/fuzz_dispatcher 2> /dev/null \
+    && head -c 150 /tmp/idispatcher_fuzz.bin | cat - /tmp/idispatcher_fuzz.rand | ./fuzz/fuzz_dispatcher 2> /dev/null; then
+    echo "Fuzz $name passed"
+else
+    echo "Fuzz $name failed"
+fi
+done
+rm -f /tmp/idispatcher_fuzz.bin /tmp/idispatcher_fuzz.rand
+if ./fuzz/difftest --seconds=5 > /dev/null; then
+    echo "Differential passed"
+else
+    echo "Differential failed"
+fi
+## Fuzz testing is done!
+echo "Fuzz testing is done!"
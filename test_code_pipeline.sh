@@ -0,0 +1,23 @@
+#!/bin/bash
+
+# checks pipelined mode gives exactly the same output as the serial loop: the results,
+# the streamed times and the snapshots, read as text, as a binary trace and from stdin
+echo "Start pipeline testing ..."
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+./traceconv "$input" /tmp/idispatcher_pipeline.bin 2> /dev/null
+if cmp -s <(./idispatcher --pipeline "$input" 2> /dev/null) "$expected" \
+    && cmp -s <(./idispatcher --pipeline < "$input" 2> /dev/null) "$expected" \
+    && cmp -s <(./idispatcher --pipeline --input-format=bin /tmp/idispatcher_pipeline.bin 2> /dev/null) "$expected" \
+    && cmp -s <(./idispatcher --pipeline --stream --snapshot-interval=3 --latency "$input" 2> /dev/null) \
+              <(./idispatcher --stream --snapshot-interval=3 --latency "$input" 2> /dev/null); then
+    echo "Pipeline $name passed"
+else
+    echo "Pipeline $name failed"
+fi
+done
+rm -f /tmp/idispatcher_pipeline.bin
+## Pipeline testing is done!
+echo "Pipeline testing is done!"
@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# checks each policy against a hand-worked trace of its own, one CPU, on which it picks a
+# different process than round robin (fifo) would at least once:
+#  - priority: 2 (priority 1) preempts 1 (priority 5) at 10, and 3 (priority 3) runs before 1
+#              when 2 exits, then keeps running through the interrupt at 30
+#  - srt: 1 has run 10 when preempted (predicted remaining 10), so 3 (new, predicted 0) runs
+#         before it when 2 exits at 15, and isn't preempted by it at 20
+#  - mlfq: 1 and 2 use up their level 0 quanta, so 3 runs at 20 ahead of 1, and 1 keeps
+#          running at 40 on level 1 (quantum 2)
+#  - stride: 1 (priority 0, 40 tickets) and 2 (priority 30, 10 tickets) share the CPU 4:1,
+#            2 running once after each 4 of 1's ticks (1's pass 104856 is still below 2's 104857)
+echo "Start policy testing ..."
+for policy in priority srt mlfq stride
+do
+input="policy_test_inputs/$policy.in"
+if cmp -s <(./idispatcher --policy=$policy "$input" 2> /dev/null) "policy_test_outputs/$policy.out" \
+        && ! cmp -s <(./idispatcher --policy=fifo "$input" 2> /dev/null) "policy_test_outputs/$policy.out"; then
+    echo "Policy $policy passed"
+else
+    echo "Policy $policy failed"
+fi
+done
+## Policy testing is done!
+echo "Policy testing is done!"
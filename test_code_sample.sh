@@ -0,0 +1,26 @@
+#!/bin/bash
+
+# checks approximate mode: with room for every process the output is the exact one plus
+# the sample lines; with room for fewer, every kept line is one of the exact lines and the
+# totals still add up over every process
+echo "Start sample testing ..."
+totals='{ n++; run += $2; ready += $3; blocked += $4 } END { printf "finished=%d run=%d ready=%d blocked=%d\n", n, run, ready, blocked }'
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+all="$(./idispatcher --sample=1000 "$input" 2> /dev/null)"
+some="$(./idispatcher --sample=2 "$input" 2> /dev/null)"
+exact="$(tail -n +2 "$expected" | awk "$totals")"
+if cmp -s <(echo "$all" | grep -v '^sample') "$expected" \
+    && [ "$(echo "$some" | head -n 1)" = "$(head -n 1 "$expected")" ] \
+    && [ -z "$(echo "$some" | tail -n +2 | grep -v '^sample' | grep -vxFf "$expected")" ] \
+    && [ "$(echo "$some" | grep '^sample finished' | sed 's/ kept=[0-9]*//; s/^sample //')" = "$exact" ] \
+    && [ "$(echo "$all" | grep '^sample finished' | sed 's/ kept=[0-9]*//; s/^sample //')" = "$exact" ]; then
+    echo "Sample $name passed"
+else
+    echo "Sample $name failed"
+fi
+done
+## Sample testing is done!
+echo "Sample testing is done!"
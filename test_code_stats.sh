@@ -0,0 +1,25 @@
+#!/bin/bash
+
+# checks --stats doesn't change the output, counts every event, and writes valid JSON
+# (needs a `make STATS=1` build; a normal build only has to refuse --stats)
+echo "Start stats testing ..."
+if ./idispatcher --stats test_inputs/test0.in 2>&1 > /dev/null | grep -q 'STATS=1'; then
+    echo "Stats skipped (not a STATS=1 build)"
+    echo "Stats testing is done!"
+    exit 0
+fi
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+events=$(tr -d '\r' < "$input" | awk '/^[ \t]*$/ { exit } { n++ } END { print n }')
+if cmp -s <(./idispatcher --stats "$input" 2> /dev/null) "$expected" \
+    && [ "$(./idispatcher --stats "$input" 2>&1 > /dev/null | grep '^stats events' | grep -o 'events_[A-Za-z]*=[0-9]*' | awk -F= '{ n += $2 } END { print n }')" = "$events" ] \
+    && ./idispatcher --stats=json "$input" 2>&1 > /dev/null | python3 -m json.tool > /dev/null; then
+    echo "Stats $name passed"
+else
+    echo "Stats $name failed"
+fi
+done
+## Stats testing is done!
+echo "Stats testing is done!"
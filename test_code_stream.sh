@@ -0,0 +1,19 @@
+#!/bin/bash
+
+# checks streaming mode prints the same times as the end-of-run output (in exit order
+# rather than by ID, with the idle time line last instead of first)
+echo "Start stream testing ..."
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+streamed="$(./idispatcher --stream "$input" 2> /dev/null)"
+if cmp -s <(echo "$streamed" | tail -n 1) <(head -n 1 "$expected") \
+    && cmp -s <(echo "$streamed" | head -n -1 | sort -n) <(tail -n +2 "$expected" | sort -n); then
+    echo "Stream $name passed"
+else
+    echo "Stream $name failed"
+fi
+done
+## Stream testing is done!
+echo "Stream testing is done!"
@@ -0,0 +1,34 @@
+#!/bin/bash
+
+# checks 64-bit times: every test with its times scaled by 10^9 (far past 32 bits) gives
+# the expected output scaled the same way, read as text and as a binary trace, with
+# --snapshot-interval given in another unit; then checks times too big for 64 bits are
+# rejected like any other invalid time
+scale='{ if(match($0, /^[0-9]+/)) { t = substr($0, 1, RLENGTH); $0 = (t == "0" ? "0" : t "000000000") substr($0, RLENGTH + 1) } print }'
+scaleOutput='{ for(i = 2; i <= NF; i++) if($i != "0") $i = $i "000000000"; print }'
+echo "Start time testing ..."
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+tr -d '\r' < "$input" | awk "$scale" > /tmp/idispatcher_time.in
+./traceconv /tmp/idispatcher_time.in /tmp/idispatcher_time.bin 2> /dev/null
+if cmp -s <(./idispatcher --time-unit=ns /tmp/idispatcher_time.in 2> /dev/null) <(awk "$scaleOutput" "$expected") \
+    && cmp -s <(./idispatcher --time-unit=ns --input-format=bin /tmp/idispatcher_time.bin 2> /dev/null) <(awk "$scaleOutput" "$expected") \
+    && cmp -s <(./idispatcher --time-unit=ns --snapshot-interval=5s /tmp/idispatcher_time.in 2> /dev/null | grep '^snapshot' | sed 's/.* running=/running=/') \
+              <(./idispatcher --snapshot-interval=5 "$input" 2> /dev/null | grep '^snapshot' | sed 's/.* running=/running=/'); then
+    echo "Time $name passed"
+else
+    echo "Time $name failed"
+fi
+done
+printf '1 C 1\n9223372036854775808 T\n2 E 1\n\n' > /tmp/idispatcher_time.in
+if ./idispatcher /tmp/idispatcher_time.in 2>&1 > /dev/null | grep -q 'time stamp' \
+    && [ "$(./idispatcher /tmp/idispatcher_time.in 2> /dev/null)" = "$(printf '0 1\n1 1 0 0')" ]; then
+    echo "Time overflow passed"
+else
+    echo "Time overflow failed"
+fi
+rm -f /tmp/idispatcher_time.in /tmp/idispatcher_time.bin
+## Time testing is done!
+echo "Time testing is done!"
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# checks tracing state transitions doesn't change the output, and that the trace is a
+# complete timeline: every state slice that's begun is ended, and the JSON is closed
+echo "Start trace testing ..."
+for input in test_inputs/test*.in pri_test_inputs/test*.in
+do
+name=$(basename "$input" .in)
+expected="$(dirname "$input" | sed 's/inputs/outputs/')/$name.out"
+if cmp -s <(./idispatcher --trace=/tmp/idispatcher_trace.json "$input" 2> /dev/null) "$expected" \
+    && [ "$(grep -o '"ph":"B"' /tmp/idispatcher_trace.json | wc -l)" = "$(grep -o '"ph":"E"' /tmp/idispatcher_trace.json | wc -l)" ] \
+    && [ "$(tail -n 1 /tmp/idispatcher_trace.json)" = "]}" ]; then
+    echo "Trace $name passed"
+else
+    echo "Trace $name failed"
+fi
+done
+# with a ring too small to keep up, transitions are dropped, but every process's slices
+# still begin and end in turn, and the number dropped is in the trace
+./tracegen --seed=19 --events=300000 --processes=200 /tmp/idispatcher_trace.in 2> /dev/null
+dropped=$(./idispatcher --trace=/tmp/idispatcher_trace.json --trace-buffer=16 /tmp/idispatcher_trace.in 2>&1 > /dev/null \
+    | sed -n 's/^Notice: \([0-9]*\) transitions were left out.*/\1/p')
+if [ -n "$dropped" ] && grep -q "\"name\":\"dropped transitions\".*\"count\":$dropped}" /tmp/idispatcher_trace.json \
+    && awk -F'"tid":' '/"ph":"[BE]"/ { split($2, f, ","); tid = f[1] + 0
+           if(/"ph":"B"/) { if(open[tid]++) bad = 1 } else if(!open[tid]--) bad = 1 }
+           END { for(tid in open) if(open[tid]) bad = 1; exit bad }' /tmp/idispatcher_trace.json \
+    && [ "$(tail -n 1 /tmp/idispatcher_trace.json)" = "]}" ]; then
+    echo "Trace dropped passed"
+else
+    echo "Trace dropped failed"
+fi
+# a time too big to convert to microseconds is written as the biggest timestamp, rather
+# than wrapping around to a negative one
+printf '0 C 1\n10000000000000 E 1\n' > /tmp/idispatcher_trace.in
+./idispatcher --time-unit=s --trace=/tmp/idispatcher_trace.json /tmp/idispatcher_trace.in > /dev/null 2>&1
+if grep -q '"ph":"E","pid":0,"tid":1,"ts":9223372036854775807}' /tmp/idispatcher_trace.json; then
+    echo "Trace big time passed"
+else
+    echo "Trace big time failed"
+fi
+rm -f /tmp/idispatcher_trace.json /tmp/idispatcher_trace.in
+## Trace testing is done!
+echo "Trace testing is done!"
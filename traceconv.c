@@ -0,0 +1,87 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Converts event traces between the text format and the binary format (see events.h)
+ *
+ * Usage: ./traceconv [--to-text] <input file> <output file>
+ * --> text to binary by default, or binary back to text with --to-text
+ * --> "-" can be given for either file to use stdin/stdout
+ */
+
+// =================================== INCLUDES ===================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "events.h"
+
+// ================================================================================
+
+int main( int argc, char *argv[] ) {
+    // get the command line options
+    int toText = 0;
+    int arg = 1;
+    if(arg < argc && strcmp(argv[arg], "--to-text") == 0) {
+        toText = 1;
+        arg++;
+    }
+    if(argc - arg != 2) {
+        fprintf(stderr, "Usage: %s [--to-text] <input file> <output file>\n", argv[0]);
+        return 1;
+    }
+
+    // open both files
+    EventReader reader;
+    if(!openReader(&reader, argv[arg], toText ? BINARY_FORMAT : TEXT_FORMAT)) {
+        fprintf(stderr, "Error: could not open input file %s\n", argv[arg]);
+        return 1;
+    }
+    FILE *out = strcmp(argv[arg+1], "-") == 0 ? stdout : fopen(argv[arg+1], toText ? "w" : "wb");
+    if(out == NULL) {
+        fprintf(stderr, "Error: could not open output file %s\n", argv[arg+1]);
+        closeReader(&reader);
+        return 1;
+    }
+
+    // convert every event (up to the blank line that ends a text trace)
+    Event next;
+    long count = 0;
+    if(!toText) {
+        unsigned char header[TRACE_HEADER_SIZE];
+        encodeHeader(header);
+        fwrite(header, TRACE_HEADER_SIZE, 1, out);
+    }
+    while(nextEvent(&reader, &next)) {
+        if(toText) {
+            if(next.type == 'R' || next.type == 'I') {
+                fprintf(out, "%lld %c %d %d\n", next.time, next.type, next.resourceNum, next.pid);
+            } else if(next.type == 'C' && next.priority != 0) {
+                fprintf(out, "%lld C %d %d\n", next.time, next.pid, next.priority);
+            } else if(next.type == 'T') {
+                fprintf(out, "%lld T\n", next.time);
+            } else {
+                fprintf(out, "%lld %c %d\n", next.time, next.type, next.pid);
+            }
+        } else {
+            unsigned char record[TRACE_RECORD_SIZE];
+            encodeRecord(&next, record);
+            fwrite(record, TRACE_RECORD_SIZE, 1, out);
+        }
+        count++;
+    }
+    if(toText) {
+        fprintf(out, "\n");
+    }
+    closeReader(&reader);
+
+    if(fflush(out) != 0 || ferror(out)) {
+        fprintf(stderr, "Error: could not write output file %s\n", argv[arg+1]);
+        return 1;
+    }
+    if(out != stdout) {
+        fclose(out);
+    }
+    fprintf(stderr, "Converted %ld events\n", count);
+    return 0;
+}
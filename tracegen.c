@@ -0,0 +1,296 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Generates a random but consistent event trace (the same seed always gives the same trace)
+ *
+ * Usage: ./tracegen [options] [output file]
+ *  --> --seed=N         random seed (default 1)
+ *  --> --events=N       about how many events to generate (default 1000)
+ *  --> --processes=N    most processes alive at once (default 100)
+ *  --> --resources=N    resources requested, numbered from 1 (default 5)
+ *  --> --timer=W --exit=W --block=W --create=W --interrupt=W
+ *                       relative weights of timer interrupts, exits, resource requests,
+ *                       creates and resource interrupts (defaults 4, 1, 3, 2, 3)
+ *  --> --time-step=N     time goes up by 1-4 times N each event (default 1), e.g. 1000000
+ *                       for a trace with the same timing in ns instead of ms
+ *  --> --format=text|bin  output format (default text, see events.h for bin)
+ *  --> the output goes to stdout if no file (or "-") is given
+ *
+ * --> The trace is consistent for the default dispatcher (one CPU, round robin): the
+ *     generator runs the same simulation, so only a running process ever exits or
+ *     requests a resource, and only a blocked process is ever interrupted
+ * --> Every event picks one of the weighted actions that's possible right now (creates
+ *     only while fewer than --processes are alive), and time goes up by 1-4 each event
+ * --> Once --events have been generated, every process left is run to completion, which
+ *     adds at most 2 events per process still alive
+ */
+
+// =================================== INCLUDES ===================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "events.h"
+
+// =================================== STRUCTS ====================================
+
+/**
+ * The simulated dispatcher state the generator keeps in step with
+ * --> ready is a ring buffer in arrival order, blocked is unordered (removed by swapping
+ *     the last one in) so a random blocked process can be interrupted in constant time
+ */
+typedef struct generator_struct {
+    uint64_t rng;
+    FILE *out;
+    InputFormat format;
+    long long count;            // events written so far
+    long long time;
+    long long timeStep;         // time goes up by 1-4 of these each event
+    int nextPID;
+    int running;                // pid of the running process, 0 if idle
+    int *ready;
+    int readyHead, readyCount;
+    int *blocked, *blockedOn;   // blocked pids, and the resource each is blocked on
+    int blockedCount;
+    int capacity;               // most processes alive at once
+    int numResources;
+} Generator;
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+uint64_t nextRandom(Generator *g);
+void emit(Generator *g, char type, int resourceNum, int pid);
+void pushReady(Generator *g, int pid);
+int popReady(Generator *g);
+void runOrReady(Generator *g, int pid);
+
+// ================================================================================
+
+int main( int argc, char *argv[] ) {
+    // get the command line options
+    long long seed = 1, events = 1000, timeStep = 1;
+    int processes = 100, resources = 5;
+    long weights[5] = { 4, 1, 3, 2, 3 };    // timer, exit, block, create, interrupt
+    const char *weightNames[5] = { "--timer=", "--exit=", "--block=", "--create=", "--interrupt=" };
+    InputFormat format = TEXT_FORMAT;
+    char *path = NULL;
+    for(int i = 1; i < argc; i++) {
+        int matched = 0;
+        for(int w = 0; w < 5; w++) {
+            size_t length = strlen(weightNames[w]);
+            if(strncmp(argv[i], weightNames[w], length) == 0 && atol(argv[i] + length) >= 0) {
+                weights[w] = atol(argv[i] + length);
+                matched = 1;
+            }
+        }
+        if(matched) {
+            continue;
+        } else if(strncmp(argv[i], "--seed=", 7) == 0) {
+            seed = atoll(argv[i] + 7);
+        } else if(strncmp(argv[i], "--events=", 9) == 0 && atoll(argv[i] + 9) >= 0) {
+            events = atoll(argv[i] + 9);
+        } else if(strncmp(argv[i], "--time-step=", 12) == 0 && atoll(argv[i] + 12) >= 1) {
+            timeStep = atoll(argv[i] + 12);
+        } else if(strncmp(argv[i], "--processes=", 12) == 0 && atoi(argv[i] + 12) >= 1) {
+            processes = atoi(argv[i] + 12);
+        } else if(strncmp(argv[i], "--resources=", 12) == 0 && atoi(argv[i] + 12) >= 1) {
+            resources = atoi(argv[i] + 12);
+        } else if(strcmp(argv[i], "--format=text") == 0) {
+            format = TEXT_FORMAT;
+        } else if(strcmp(argv[i], "--format=bin") == 0) {
+            format = BINARY_FORMAT;
+        } else if((strncmp(argv[i], "--", 2) == 0 && strcmp(argv[i], "-") != 0) || path != NULL) {
+            fprintf(stderr, "Error: unexpected argument %s\n", argv[i]);
+            fprintf(stderr, "Usage: %s [--seed=N] [--events=N] [--processes=N] [--resources=N]\n"
+                            "       [--timer=W] [--exit=W] [--block=W] [--create=W] [--interrupt=W]\n"
+                            "       [--time-step=N] [--format=text|bin] [output file]\n", argv[0]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
+    }
+    if(weights[3] == 0 || (weights[0] + weights[1] + weights[2] == 0)) {
+        fprintf(stderr, "Error: the create weight and at least one of the timer, exit and block weights must be positive\n");
+        return 1;
+    }
+
+    // open the output
+    Generator g;
+    memset(&g, 0, sizeof(g));
+    g.out = (path == NULL || strcmp(path, "-") == 0) ? stdout : fopen(path, format == BINARY_FORMAT ? "wb" : "w");
+    if(g.out == NULL) {
+        fprintf(stderr, "Error: could not open output file %s\n", path);
+        return 1;
+    }
+    g.rng = (uint64_t)seed;
+    g.format = format;
+    g.timeStep = timeStep;
+    g.nextPID = 1;
+    g.capacity = processes;
+    g.numResources = resources;
+    g.ready = malloc(processes * sizeof(int));
+    g.blocked = malloc(processes * sizeof(int));
+    g.blockedOn = malloc(processes * sizeof(int));
+    if(format == BINARY_FORMAT) {
+        unsigned char header[TRACE_HEADER_SIZE];
+        encodeHeader(header);
+        fwrite(header, TRACE_HEADER_SIZE, 1, g.out);
+    }
+
+    // generate events, each a weighted pick among the actions possible right now
+    while(g.count < events) {
+        int alive = (g.running != 0) + g.readyCount + g.blockedCount;
+        long possible[5];
+        possible[0] = possible[1] = possible[2] = (g.running != 0);
+        possible[3] = (alive < g.capacity);
+        possible[4] = (g.blockedCount > 0);
+        long total = 0;
+        for(int w = 0; w < 5; w++) {
+            total += possible[w] * weights[w];
+        }
+        // (with --interrupt=0, once every process is blocked nothing is left to pick, so one
+        // is unblocked anyway)
+        int action = 4;
+        if(total > 0) {
+            long pick = (long)(nextRandom(&g) % (uint64_t)total);
+            action = 0;
+            while(pick >= possible[action] * weights[action]) {
+                pick -= possible[action] * weights[action];
+                action++;
+            }
+        }
+
+        if(action == 0) {           // T: the running process goes to the back if others are ready
+            emit(&g, 'T', -1, -1);
+            if(g.readyCount > 0) {
+                pushReady(&g, g.running);
+                g.running = popReady(&g);
+            }
+        } else if(action == 1) {    // E: the running process exits
+            emit(&g, 'E', -1, g.running);
+            g.running = popReady(&g);
+        } else if(action == 2) {    // R: the running process blocks on a random resource
+            int resourceNum = 1 + (int)(nextRandom(&g) % (uint64_t)g.numResources);
+            emit(&g, 'R', resourceNum, g.running);
+            g.blocked[g.blockedCount] = g.running;
+            g.blockedOn[g.blockedCount++] = resourceNum;
+            g.running = popReady(&g);
+        } else if(action == 3) {    // C: a new process
+            emit(&g, 'C', -1, g.nextPID);
+            runOrReady(&g, g.nextPID++);
+        } else {                    // I: a random blocked process is unblocked
+            int which = (int)(nextRandom(&g) % (uint64_t)g.blockedCount);
+            int pid = g.blocked[which];
+            emit(&g, 'I', g.blockedOn[which], pid);
+            g.blocked[which] = g.blocked[--g.blockedCount];
+            g.blockedOn[which] = g.blockedOn[g.blockedCount];
+            runOrReady(&g, pid);
+        }
+    }
+
+    // run everything left to completion (so nothing is still ready or blocked at the end)
+    while(g.running != 0 || g.blockedCount > 0) {
+        if(g.running != 0) {
+            emit(&g, 'E', -1, g.running);
+            g.running = popReady(&g);
+        } else {
+            int pid = g.blocked[--g.blockedCount];
+            emit(&g, 'I', g.blockedOn[g.blockedCount], pid);
+            runOrReady(&g, pid);
+        }
+    }
+    if(format == TEXT_FORMAT) {
+        fprintf(g.out, "\n");
+    }
+
+    int failed = fflush(g.out) != 0 || ferror(g.out);
+    if(g.out != stdout) {
+        fclose(g.out);
+    }
+    free(g.ready);
+    free(g.blocked);
+    free(g.blockedOn);
+    if(failed) {
+        fprintf(stderr, "Error: could not write output file %s\n", path);
+        return 1;
+    }
+    fprintf(stderr, "Generated %lld events\n", g.count);
+    return 0;
+}
+
+// ================================== MY HELPERS ==================================
+
+/**
+ * Gets the next pseudo-random number (splitmix64, so traces are the same on every platform)
+ * @param Generator *g -the generator (its state is advanced)
+ * @return the next 64-bit number
+ */
+uint64_t nextRandom(Generator *g) {
+    uint64_t z = (g->rng += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * Writes one event at the next time stamp
+ * @param Generator *g -the generator
+ * @param char type -the event
+ * @param int resourceNum -the resource number ('R' and 'I' only, otherwise -1)
+ * @param int pid -the process ID (-1 for 'T')
+ */
+void emit(Generator *g, char type, int resourceNum, int pid) {
+    g->time += (1 + (long long)(nextRandom(g) & 3)) * g->timeStep;
+    g->count++;
+    if(g->format == BINARY_FORMAT) {
+        Event event = { g->time, type, resourceNum, pid, 0 };
+        unsigned char record[TRACE_RECORD_SIZE];
+        encodeRecord(&event, record);
+        fwrite(record, TRACE_RECORD_SIZE, 1, g->out);
+    } else if(type == 'T') {
+        fprintf(g->out, "%lld T\n", g->time);
+    } else if(type == 'R' || type == 'I') {
+        fprintf(g->out, "%lld %c %d %d\n", g->time, type, resourceNum, pid);
+    } else {
+        fprintf(g->out, "%lld %c %d\n", g->time, type, pid);
+    }
+}
+
+/**
+ * Adds a process to the back of the ready queue
+ * @param Generator *g -the generator
+ * @param int pid -the process
+ */
+void pushReady(Generator *g, int pid) {
+    g->ready[(g->readyHead + g->readyCount++) % g->capacity] = pid;
+}
+
+/**
+ * Takes the process at the front of the ready queue
+ * @param Generator *g -the generator
+ * @return its pid, or 0 if nothing is ready
+ */
+int popReady(Generator *g) {
+    if(g->readyCount == 0) {
+        return 0;
+    }
+    int pid = g->ready[g->readyHead];
+    g->readyHead = (g->readyHead + 1) % g->capacity;
+    g->readyCount--;
+    return pid;
+}
+
+/**
+ * Runs a process that was just created or unblocked if nothing is running, otherwise readies it
+ * @param Generator *g -the generator
+ * @param int pid -the process
+ */
+void runOrReady(Generator *g, int pid) {
+    if(g->running == 0) {
+        g->running = pid;
+    } else {
+        pushReady(g, pid);
+    }
+}
@@ -0,0 +1,270 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Transition traces: every process state change, written out as a Chrome trace-event
+ *     JSON timeline by a background thread
+ * --> Each process is its own track (tid = its pid, named "pid N"): a state it's in is a
+ *     slice from the transition into it until the transition out of it, with the CPU and
+ *     resource as arguments, so a replay can be viewed in chrome://tracing or Perfetto
+ * --> ts is in microseconds (the trace's times are converted from its time unit)
+ * --> If transitions were dropped (the ring was full), a process whose next transition
+ *     doesn't start from the state it was last traced in has that slice ended there, with
+ *     a "dropped transitions" instant event on its track, and the number dropped is a
+ *     global instant event at the end
+ * --> Slices still open at the end (processes that never exited, or whose exit was
+ *     dropped) are ended at the last time traced, so every slice begun is ended
+ */
+
+// =================================== INCLUDES ===================================
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <time.h>
+
+#include "tracesink.h"
+
+#define WRITER_IDLE_NS 200000   // how long the writer sleeps when it's caught up
+
+// ================================== MY HELPERS ==================================
+
+/**
+ * Helper that gets the name of a process state
+ * @param int state -the state (a ProcessState)
+ * @return its name
+ */
+static const char* stateName(int state) {
+    const char *names[] = { "NEW", "RUNNING", "READY", "BLOCKED", "TERMINATED" };
+    return state >= NEW && state <= TERMINATED ? names[state] : "UNKNOWN";
+}
+
+/**
+ * Helper that gets the state a process's open slice is for
+ * --> the open index maps each pid to its state in place of a slot (states are far below
+ *     NO_SLOT, so they can't be mistaken for it)
+ * @param TraceSink *sink -the sink
+ * @param int pid -the process
+ * @return its state (a ProcessState), or -1 if it has no slice open
+ */
+static int tracedState(TraceSink *sink, int pid) {
+    Slot state = indexFind(&sink->open, pid);
+    return state == NO_SLOT ? -1 : (int)state;
+}
+/**
+ * Helper that records the state a process's newly opened slice is for
+ * @param TraceSink *sink -the sink
+ * @param int pid -the process (with no slice open)
+ * @param int state -its state (a ProcessState)
+ */
+static void setTracedState(TraceSink *sink, int pid, int state) {
+    indexInsert(&sink->open, pid, (Slot)state);
+}
+
+/**
+ * Helper that writes a time as a trace-event timestamp (microseconds)
+ * --> a time too big to convert is written as the biggest one that can be
+ * @param TraceSink *sink -the sink
+ * @param long long time -the time, in the trace's time unit
+ */
+static void writeTimestamp(TraceSink *sink, long long time) {
+    if(sink->unitNs >= 1000) {
+        long long scale = sink->unitNs / 1000;
+        fprintf(sink->out, "%lld", time > LLONG_MAX / scale ? LLONG_MAX : time * scale);
+    } else {
+        long long ns = time > LLONG_MAX / sink->unitNs ? LLONG_MAX : time * sink->unitNs;
+        fprintf(sink->out, "%lld.%03lld", ns / 1000, ns % 1000);
+    }
+}
+
+/**
+ * Helper that ends the slice a process has open
+ * @param TraceSink *sink -the sink
+ * @param int pid -the process
+ * @param long long time -when it ends
+ */
+static void writeEnd(TraceSink *sink, int pid, long long time) {
+    fprintf(sink->out, "%s\n{\"ph\":\"E\",\"pid\":0,\"tid\":%d,\"ts\":", sink->first ? "" : ",", pid);
+    writeTimestamp(sink, time);
+    fprintf(sink->out, "}");
+    sink->first = 0;
+}
+
+/**
+ * Helper that writes an instant event marking dropped transitions
+ * @param TraceSink *sink -the sink
+ * @param int pid -the process whose track it goes on (-1 for a global one)
+ * @param long long time -when
+ * @param long long count -how many were dropped (-1 if it isn't known)
+ */
+static void writeDropped(TraceSink *sink, int pid, long long time, long long count) {
+    fprintf(sink->out, "%s\n{\"name\":\"dropped transitions\",\"ph\":\"i\",\"pid\":0,\"tid\":%d,\"s\":\"%c\",\"ts\":",
+            sink->first ? "" : ",", pid < 0 ? 0 : pid, pid < 0 ? 'g' : 't');
+    writeTimestamp(sink, time);
+    if(count >= 0) {
+        fprintf(sink->out, ",\"args\":{\"count\":%lld}", count);
+    }
+    fprintf(sink->out, "}");
+    sink->first = 0;
+}
+
+/**
+ * Helper that writes the trace events for one transition: the end of the slice for the
+ * state it left, and the start of one for the state it entered
+ * --> if the process's slice isn't for the state it left (transitions of it were dropped),
+ *     that slice is ended here and the gap is marked instead
+ * @param TraceSink *sink -the sink
+ * @param const Transition *t -the transition
+ */
+static void writeTransition(TraceSink *sink, const Transition *t) {
+    int traced = tracedState(sink, t->pid);
+    if(t->from == NEW) {
+        if(traced >= 0) {
+            writeEnd(sink, t->pid, t->time);
+            writeDropped(sink, t->pid, t->time, -1);
+        }
+        fprintf(sink->out, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"pid %d\"}}",
+                sink->first ? "" : ",", t->pid, t->pid);
+        sink->first = 0;
+    } else if(traced == t->from) {
+        writeEnd(sink, t->pid, t->time);
+    } else {
+        if(traced >= 0) {
+            writeEnd(sink, t->pid, t->time);
+        }
+        writeDropped(sink, t->pid, t->time, -1);
+    }
+    if(traced >= 0) {
+        indexRemove(&sink->open, t->pid);
+    }
+    if(t->to != TERMINATED) {
+        fprintf(sink->out, ",\n{\"name\":\"%s\",\"ph\":\"B\",\"pid\":0,\"tid\":%d,\"ts\":", stateName(t->to), t->pid);
+        writeTimestamp(sink, t->time);
+        fprintf(sink->out, ",\"args\":{\"cpu\":%d,\"resource\":%d}}", t->cpu, t->resource);
+        setTracedState(sink, t->pid, t->to);
+    }
+    sink->lastTime = t->time;
+}
+
+/**
+ * Helper that runs the writer thread: drains the ring into the file until the sink is
+ * closed and everything in it has been written
+ * @param void *arg -the sink
+ * @return NULL
+ */
+static void* runWriter(void *arg) {
+    TraceSink *sink = arg;
+    size_t tail = sink->tail;
+    while(1) {
+        size_t head = __atomic_load_n(&sink->head, __ATOMIC_ACQUIRE);
+        if(tail == head) {
+            // caught up: stop if nothing more is coming (checking head again after done,
+            // since transitions added before it was set might not have been seen yet)
+            if(__atomic_load_n(&sink->done, __ATOMIC_ACQUIRE)) {
+                if(tail == __atomic_load_n(&sink->head, __ATOMIC_ACQUIRE)) {
+                    break;
+                }
+                continue;
+            }
+            struct timespec idle = { 0, WRITER_IDLE_NS };
+            nanosleep(&idle, NULL);
+            continue;
+        }
+        while(tail != head) {
+            writeTransition(sink, &sink->ring[tail & sink->mask]);
+            tail++;
+        }
+        __atomic_store_n(&sink->tail, tail, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+// ============================== TRACE SINK FUNCTIONS ============================
+
+/**
+ * Opens a trace file and starts the thread that writes it
+ * @param const char *path -the file to write
+ * @param size_t capacity -how many transitions the ring holds (rounded up to a power of 2)
+ * @param long long unitNs -how many nanoseconds one time unit of the trace is
+ * @return the sink, or NULL if the file couldn't be opened (or the thread started)
+ */
+TraceSink* openTraceSink(const char *path, size_t capacity, long long unitNs) {
+    TraceSink *sink = calloc(1, sizeof(TraceSink));
+    sink->out = fopen(path, "w");
+    if(sink->out == NULL) {
+        free(sink);
+        return NULL;
+    }
+    size_t size = 1;
+    while(size < capacity) {
+        size *= 2;
+    }
+    sink->ring = malloc(size * sizeof(Transition));
+    sink->mask = size - 1;
+    sink->unitNs = unitNs;
+    sink->first = 1;
+    initIndex(&sink->open);
+    fprintf(sink->out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    if(pthread_create(&sink->writer, NULL, runWriter, sink) != 0) {
+        fclose(sink->out);
+        deleteIndex(&sink->open);
+        free(sink->ring);
+        free(sink);
+        return NULL;
+    }
+    return sink;
+}
+
+/**
+ * Adds a transition to the ring without waiting (it's dropped if the ring is full)
+ * @param TraceSink *sink -the sink
+ * @param long long time -when it happened
+ * @param int pid -the process
+ * @param ProcessState from -the state it left
+ * @param ProcessState to -the state it entered
+ * @param int resource -the resource it's blocked on (0 if none)
+ * @param int cpu -the CPU it's on, or whose ready queue it's in (-1 if none)
+ */
+void traceTransition(TraceSink *sink, long long time, int pid, ProcessState from, ProcessState to,
+                     int resource, int cpu) {
+    size_t head = sink->head;
+    if(head - __atomic_load_n(&sink->tail, __ATOMIC_ACQUIRE) > sink->mask) {
+        sink->dropped++;
+        return;
+    }
+    Transition *t = &sink->ring[head & sink->mask];
+    t->time = time;
+    t->pid = pid;
+    t->resource = resource;
+    t->cpu = cpu;
+    t->from = (uint8_t)from;
+    t->to = (uint8_t)to;
+    __atomic_store_n(&sink->head, head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * Waits for everything added to be written, then finishes the file and frees the sink
+ * --> slices left open are ended at the last time traced, then how many transitions were
+ *     dropped is written (if any were)
+ * @param TraceSink *sink -the sink
+ * @return how many transitions were dropped because the ring was full
+ */
+long long closeTraceSink(TraceSink *sink) {
+    __atomic_store_n(&sink->done, 1, __ATOMIC_RELEASE);
+    pthread_join(sink->writer, NULL);
+    long long dropped = sink->dropped;
+    for(int i = 0; i < sink->open.capacity; i++) {
+        if(sink->open.slots[i].slot != NO_SLOT) {
+            writeEnd(sink, sink->open.slots[i].pid, sink->lastTime);
+        }
+    }
+    if(dropped > 0) {
+        writeDropped(sink, -1, sink->lastTime, dropped);
+    }
+    fprintf(sink->out, "\n]}\n");
+    fclose(sink->out);
+    deleteIndex(&sink->open);
+    free(sink->ring);
+    free(sink);
+    return dropped;
+}
@@ -0,0 +1,67 @@
+/**
+ * Mitchell Van Braeckel (mvanbrae@uoguelph.ca) 1002297
+ * 11/03/2019
+ * CIS*3110: Operating Systems A3 - CPU Scheduling: Simple Dispatcher
+ * --> Transition traces: every process state change, written out as a Chrome trace-event
+ *     JSON timeline by a background thread
+ */
+
+#ifndef TRACESINK_H
+#define TRACESINK_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "pcb.h"
+
+#define TRACE_SINK_CAPACITY (1 << 18)   // default ring size, in transitions
+
+// =================================== STRUCTS ====================================
+
+/**
+ * One process state change
+ */
+typedef struct transition_struct {
+    long long time;
+    int pid;
+    int resource;           // resource it's blocked on (0 if it isn't blocked)
+    int cpu;                // CPU it's running on, or whose ready queue it's in (-1 if none)
+    uint8_t from, to;       // ProcessStates
+} Transition;
+
+/**
+ * A single-producer single-consumer ring of transitions, and the thread that drains it
+ * --> the dispatcher only ever writes head and the writer thread only ever writes tail
+ *     (each published with release/acquire atomics, no locks), on separate cache lines
+ * --> the ring is allocated up front; if the writer falls a whole ring behind, further
+ *     transitions are dropped (and counted) rather than making the dispatcher wait, and
+ *     the writer keeps the timeline whole around the gaps (see writeTransition)
+ */
+typedef struct trace_sink_struct {
+    Transition *ring;
+    size_t mask;                // capacity - 1 (the capacity is a power of two)
+    char padHead[64];
+    size_t head;                // next slot the dispatcher fills
+    long long dropped;          // transitions lost to a full ring (dispatcher only)
+    char padTail[64];
+    size_t tail;                // next slot the writer empties
+    int done;                   // set once nothing more will be added
+    char padWriter[64];
+    FILE *out;
+    long long unitNs;           // how many nanoseconds one time unit of the trace is
+    int first;                  // 1 until the first trace event has been written
+    PIDIndex open;              // each process with a slice begun, mapped to its state (see tracedState)
+    long long lastTime;         // time of the last transition written
+    pthread_t writer;
+} TraceSink;
+
+// ============================== FUNCTION PROTOTYPES =============================
+
+TraceSink* openTraceSink(const char *path, size_t capacity, long long unitNs);
+void traceTransition(TraceSink *sink, long long time, int pid, ProcessState from, ProcessState to,
+                     int resource, int cpu);
+long long closeTraceSink(TraceSink *sink);
+
+#endif